@@ -0,0 +1,918 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Линейный (bump) аллокатор: память выделяется последовательно из крупных блоков
+// и освобождается вся сразу в Release или деструкторе.
+// Не потокобезопасен: предполагается одна арена на запрос или поток
+class BumpArena : public std::pmr::memory_resource {
+public:
+    explicit BumpArena(size_t initial_block_size = 4096,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream)
+        , next_block_size_(initial_block_size < kMinBlockSize ? kMinBlockSize : initial_block_size) {
+    }
+
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+
+    ~BumpArena() override {
+        Release();
+    }
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        char* result = AlignUp(cursor_, alignment);
+        if (result == nullptr || bytes > static_cast<size_t>(end_ - result)) {
+            AddBlock(bytes + alignment);
+            result = AlignUp(cursor_, alignment);
+        }
+        cursor_ = result + bytes;
+        bytes_used_ += bytes;
+        return result;
+    }
+
+    // Память возвращается только при Release. Исключение — последнее выделение:
+    // его можно откатить, что удешевляет временные буферы
+    void Deallocate(void* p, size_t bytes, size_t /*alignment*/ = alignof(std::max_align_t)) noexcept {
+        if (static_cast<char*>(p) + bytes == cursor_) {
+            cursor_ = static_cast<char*>(p);
+        }
+    }
+
+    // Увеличивает последнее выделение на месте, если в текущем блоке хватает места
+    bool TryExpand(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+        char* block = static_cast<char*>(p);
+        if (block + old_bytes != cursor_ || new_bytes > static_cast<size_t>(end_ - block)) {
+            return false;
+        }
+        cursor_ = block + new_bytes;
+        bytes_used_ += new_bytes - old_bytes;
+        return true;
+    }
+
+    // Освобождает все блоки арены. Все выделенные из неё указатели становятся недействительными
+    void Release() noexcept {
+        while (head_ != nullptr) {
+            BlockHeader* prev = head_->prev;
+            upstream_->deallocate(head_, head_->size, alignof(std::max_align_t));
+            head_ = prev;
+        }
+        cursor_ = nullptr;
+        end_ = nullptr;
+        bytes_used_ = 0;
+    }
+
+    // Суммарный объём памяти, выделенный пользователям арены с момента последнего Release
+    size_t BytesUsed() const noexcept {
+        return bytes_used_;
+    }
+
+private:
+    struct BlockHeader {
+        BlockHeader* prev;
+        size_t size;
+    };
+
+    static constexpr size_t kMinBlockSize = 256;
+
+    static char* AlignUp(char* p, size_t alignment) noexcept {
+        if (p == nullptr) {
+            return nullptr;
+        }
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        return p + ((alignment - address % alignment) % alignment);
+    }
+
+    void AddBlock(size_t min_bytes) {
+        size_t size = next_block_size_;
+        while (size < min_bytes + sizeof(BlockHeader)) {
+            size *= 2;
+        }
+        void* memory = upstream_->allocate(size, alignof(std::max_align_t));
+        head_ = new (memory) BlockHeader{head_, size};
+        cursor_ = reinterpret_cast<char*>(head_ + 1);
+        end_ = static_cast<char*>(memory) + size;
+        next_block_size_ = size * 2;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return Allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        Deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    BlockHeader* head_ = nullptr;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t next_block_size_;
+    size_t bytes_used_ = 0;
+};
+
+// Пул блоков фиксированных размеров (степени двойки от 8 байт до 64 КиБ).
+// Освобождённый блок попадает в список свободных блоков своего класса и
+// переиспользуется следующим выделением того же класса.
+// Блок класса выровнен по своему размеру, но не сильнее, чем max_align_t.
+// Более крупные запросы и запросы с большим выравниванием уходят напрямую в upstream.
+// Не потокобезопасен
+class PoolResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kMinBlockSize = 8;
+    static constexpr size_t kMaxBlockSize = 64 * 1024;
+
+    explicit PoolResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    ~PoolResource() override {
+        Release();
+    }
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (!IsPooled(bytes, alignment)) {
+            return upstream_->allocate(bytes, alignment);
+        }
+        const size_t index = ClassIndex(std::max(bytes, alignment));
+        if (free_lists_[index] == nullptr) {
+            Refill(index);
+        }
+        FreeNode* node = free_lists_[index];
+        free_lists_[index] = node->next;
+        return node;
+    }
+
+    void Deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) noexcept {
+        if (!IsPooled(bytes, alignment)) {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        const size_t index = ClassIndex(std::max(bytes, alignment));
+        free_lists_[index] = new (p) FreeNode{free_lists_[index]};
+    }
+
+    // Возвращает в upstream все блоки пула
+    void Release() noexcept {
+        while (chunks_ != nullptr) {
+            ChunkHeader* next = chunks_->next;
+            upstream_->deallocate(chunks_, chunks_->size, kChunkAlignment);
+            chunks_ = next;
+        }
+        free_lists_.fill(nullptr);
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct alignas(std::max_align_t) ChunkHeader {
+        ChunkHeader* next;
+        size_t size;
+    };
+
+    static constexpr size_t kChunkAlignment = alignof(std::max_align_t);
+    static constexpr size_t kChunkBytes = 64 * 1024;
+    static constexpr size_t kMinBlocksPerChunk = 4;
+    static constexpr size_t kNumClasses = 14;  // 8 Б ... 64 КиБ
+
+    static bool IsPooled(size_t bytes, size_t alignment) noexcept {
+        return bytes <= kMaxBlockSize && alignment <= kChunkAlignment;
+    }
+
+    static size_t ClassIndex(size_t bytes) noexcept {
+        size_t index = 0;
+        for (size_t size = kMinBlockSize; size < bytes; size *= 2) {
+            ++index;
+        }
+        return index;
+    }
+
+    static size_t ClassSize(size_t index) noexcept {
+        return kMinBlockSize << index;
+    }
+
+    void Refill(size_t index) {
+        const size_t block_size = ClassSize(index);
+        const size_t count = std::max(kMinBlocksPerChunk, kChunkBytes / block_size);
+        const size_t size = sizeof(ChunkHeader) + count * block_size;
+        void* memory = upstream_->allocate(size, kChunkAlignment);
+        chunks_ = new (memory) ChunkHeader{chunks_, size};
+
+        char* blocks = reinterpret_cast<char*>(chunks_ + 1);
+        for (size_t i = count; i > 0; --i) {
+            free_lists_[index] = new (blocks + (i - 1) * block_size) FreeNode{free_lists_[index]};
+        }
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return Allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        Deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::array<FreeNode*, kNumClasses> free_lists_{};
+    ChunkHeader* chunks_ = nullptr;
+};
+
+// Типизированный аллокатор поверх BumpArena или PoolResource.
+// В отличие от std::pmr::polymorphic_allocator вызывает ресурс без виртуальной диспетчеризации.
+// Как и polymorphic_allocator, не распространяется при присваивании и обмене контейнеров
+template <typename T, typename Resource>
+class ResourceAllocator {
+public:
+    using value_type = T;
+
+    explicit ResourceAllocator(Resource* resource) noexcept
+        : resource_(resource) {
+        assert(resource_ != nullptr);
+    }
+
+    template <typename U>
+    ResourceAllocator(const ResourceAllocator<U, Resource>& other) noexcept
+        : resource_(other.GetResource()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(resource_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        resource_->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    // Доступно, если ресурс умеет расширять выделенный блок на месте (BumpArena)
+    template <typename R = Resource>
+    auto try_expand(T* p, size_t old_n, size_t new_n) noexcept
+        -> decltype(std::declval<R&>().TryExpand(p, old_n, new_n)) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return false;
+        }
+        return resource_->TryExpand(p, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    Resource* GetResource() const noexcept {
+        return resource_;
+    }
+
+    template <typename U>
+    bool operator==(const ResourceAllocator<U, Resource>& other) const noexcept {
+        return resource_ == other.GetResource();
+    }
+
+    template <typename U>
+    bool operator!=(const ResourceAllocator<U, Resource>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    Resource* resource_;
+};
+
+// Аллокатор поверх malloc/free. Поддерживает расширения RawMemory:
+// allocate_at_least забирает запас блока, который malloc выделил сверх запрошенного,
+// а reallocate вызывает realloc. Для больших блоков glibc выполняет realloc через mremap,
+// то есть без копирования данных — меняются только таблицы страниц.
+// try_expand нет: байты сверх запрошенного принадлежат вектору, только если их узаконил
+// realloc, а realloc может перенести блок, чего try_expand сообщить не может
+template <typename T>
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "malloc does not guarantee alignment stricter than max_align_t");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* p = std::malloc(n * sizeof(T));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    // Сообщает фактический размер блока, чтобы ёмкость вектора совпадала с классом размера malloc
+    auto allocate_at_least(size_t n) {
+        struct Result {
+            T* ptr;
+            size_t count;
+        };
+        T* p = allocate(n);
+#if defined(__GLIBC__)
+        const size_t count = std::max(n, malloc_usable_size(p) / sizeof(T));
+        if (count > n) {
+            // Запас блока узаконивается через realloc: glibc возвращает тот же указатель
+            if (void* fitted = std::realloc(static_cast<void*>(p), count * sizeof(T))) {
+                p = static_cast<T*>(fitted);
+            } else {
+                return Result{p, n};
+            }
+        }
+        return Result{p, count};
+#else
+        return Result{p, n};
+#endif
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        std::free(p);
+    }
+
+    T* reallocate(T* p, size_t /*old_n*/, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::realloc(static_cast<void*>(p), new_n * sizeof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Аллокатор с выравниванием буферов по Alignment байт через выровненный operator new,
+// например по кэш-линии или по ширине регистра AVX-512. Ёмкость округляется так,
+// чтобы буфер занимал целое число блоков по Alignment байт: векторный цикл может читать
+// последний блок целиком, не выходя за пределы выделенной памяти
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_t kAlignment = Alignment;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, std::max(Alignment, alignof(U))>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U, size_t OtherAlignment>
+    AlignedAllocator(const AlignedAllocator<U, OtherAlignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - Alignment) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    auto allocate_at_least(size_t n) {
+        struct Result {
+            T* ptr;
+            size_t count;
+        };
+        if (n > (std::numeric_limits<size_t>::max() - Alignment) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        // Если блоки не делятся на sizeof(T) нацело, хвост последнего блока короче элемента
+        // и в ёмкость не входит, но выделяется всё равно
+        const size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        return Result{static_cast<T*>(::operator new(bytes, std::align_val_t{Alignment})),
+                      bytes / sizeof(T)};
+    }
+
+    // Размер n не передаётся в operator delete: буфер мог быть длиннее n элементов
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator==(const AlignedAllocator<U, OtherAlignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator!=(const AlignedAllocator<U, OtherAlignment>&) const noexcept {
+        return false;
+    }
+};
+
+namespace detail {
+
+// Кэш освобождённых блоков RecyclingAllocator, свой у каждого потока. Блоки от 64 байт
+// до 1 МиБ округляются до степени двойки, и в каждом классе хранится не больше
+// kMaxBlocksPerClass свободных блоков; остальные сразу возвращаются operator delete.
+// Списки тривиально разрушаемы, поэтому блоки, освобождаемые после завершения потока
+// (например, деструкторами других thread_local объектов), просто уходят в operator delete
+class RecyclingCache {
+public:
+    static constexpr size_t kMinBlockSize = 64;
+    static constexpr size_t kMaxBlockSize = 1024 * 1024;
+    static constexpr size_t kMaxBlocksPerClass = 8;
+
+    // Размер блока, который выделяется под bytes байт
+    static size_t BlockSize(size_t bytes) noexcept {
+        if (bytes > kMaxBlockSize) {
+            return bytes;
+        }
+        size_t size = kMinBlockSize;
+        while (size < bytes) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    // block_size — результат BlockSize
+    static void* Allocate(size_t block_size) {
+        if (block_size <= kMaxBlockSize) {
+            Lists& lists = local_lists;
+            const size_t index = ClassIndex(block_size);
+            if (FreeNode* node = lists.heads[index]) {
+                lists.heads[index] = node->next;
+                --lists.counts[index];
+                return node;
+            }
+        }
+        return ::operator new(block_size);
+    }
+
+    static void Deallocate(void* p, size_t block_size) noexcept {
+        Lists& lists = local_lists;
+        if (block_size <= kMaxBlockSize && !lists.closed) {
+            const size_t index = ClassIndex(block_size);
+            if (lists.counts[index] < kMaxBlocksPerClass) {
+                if (!lists.registered) {
+                    // Регистрирует очистку списков при завершении потока
+                    thread_local Flusher flusher;
+                    static_cast<void>(flusher);
+                    lists.registered = true;
+                }
+                lists.heads[index] = new (p) FreeNode{lists.heads[index]};
+                ++lists.counts[index];
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+    // Число свободных блоков в кэше текущего потока
+    static size_t CachedBlocks() noexcept {
+        size_t total = 0;
+        for (const size_t count : local_lists.counts) {
+            total += count;
+        }
+        return total;
+    }
+
+    // Возвращает operator delete все свободные блоки текущего потока
+    static void Trim() noexcept {
+        Lists& lists = local_lists;
+        for (size_t index = 0; index < kNumClasses; ++index) {
+            while (FreeNode* node = lists.heads[index]) {
+                lists.heads[index] = node->next;
+                ::operator delete(node);
+            }
+            lists.counts[index] = 0;
+        }
+    }
+
+private:
+    static constexpr size_t kNumClasses = 15;  // 64 Б ... 1 МиБ
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct Lists {
+        FreeNode* heads[kNumClasses];
+        size_t counts[kNumClasses];
+        bool registered;
+        bool closed;
+    };
+
+    struct Flusher {
+        ~Flusher() {
+            Trim();
+            local_lists.closed = true;
+        }
+    };
+
+    static size_t ClassIndex(size_t block_size) noexcept {
+        size_t index = 0;
+        for (size_t size = kMinBlockSize; size < block_size; size *= 2) {
+            ++index;
+        }
+        return index;
+    }
+
+    inline static thread_local Lists local_lists{};
+};
+
+}  // namespace detail
+
+// Аллокатор, возвращающий освобождённые буферы в кэш потока (detail::RecyclingCache)
+// и переиспользующий их при следующем выделении того же класса размеров. Рабочие векторы,
+// которые заполняются и разрушаются на каждом запросе, в установившемся режиме
+// не обращаются к operator new. allocate_at_least отдаёт блок класса целиком.
+// Буфер можно освободить в любом потоке: он попадёт в кэш освобождающего потока
+template <typename T>
+class RecyclingAllocator {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "operator new does not guarantee the alignment of T");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    RecyclingAllocator() = default;
+
+    template <typename U>
+    RecyclingAllocator(const RecyclingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    auto allocate_at_least(size_t n) {
+        struct Result {
+            T* ptr;
+            size_t count;
+        };
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t block_size = detail::RecyclingCache::BlockSize(n * sizeof(T));
+        return Result{static_cast<T*>(detail::RecyclingCache::Allocate(block_size)), block_size / sizeof(T)};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        detail::RecyclingCache::Deallocate(p, detail::RecyclingCache::BlockSize(n * sizeof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const RecyclingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const RecyclingAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+#if defined(__linux__)
+
+// Страницы, которыми отображаются крупные буферы LargePageAllocator
+enum class LargePageKind {
+    kTransparent,  // обычное отображение с MADV_HUGEPAGE: ядро собирает страницы по 2 МиБ само
+    kHuge2M,       // явные страницы hugetlbfs по 2 МиБ
+    kHuge1G,       // явные страницы hugetlbfs по 1 ГиБ
+};
+
+// Размещение крупных буферов по узлам NUMA (политика mbind)
+enum class NumaPolicy {
+    kDefault,     // страница достаётся узлу потока, первым её коснувшегося
+    kBind,        // только узлы из node_mask
+    kInterleave,  // страницы по очереди распределяются по узлам из node_mask
+};
+
+struct LargePageOptions {
+    // Буферы меньшего размера выделяются через operator new
+    size_t threshold_bytes = size_t{2} << 20;
+    LargePageKind pages = LargePageKind::kTransparent;
+    NumaPolicy numa = NumaPolicy::kDefault;
+    // Бит i соответствует узлу NUMA i
+    unsigned long node_mask = 0;
+
+    bool operator==(const LargePageOptions& other) const noexcept {
+        return threshold_bytes == other.threshold_bytes && pages == other.pages
+            && numa == other.numa && node_mask == other.node_mask;
+    }
+
+    bool operator!=(const LargePageOptions& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+namespace detail {
+
+// Значения из <numaif.h>: mbind вызывается напрямую, без зависимости от libnuma
+inline constexpr int kMpolBind = 2;
+inline constexpr int kMpolInterleave = 3;
+
+inline constexpr size_t kHugePage2M = size_t{2} << 20;
+inline constexpr size_t kHugePage1G = size_t{1} << 30;
+
+// Отображения крупных буферов LargePageAllocator, не зависящие от типа элементов
+class LargePageMapper {
+public:
+    explicit LargePageMapper(const LargePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    bool IsLarge(size_t bytes) const noexcept {
+        return bytes >= options_.threshold_bytes;
+    }
+
+    // Длина отображения для буфера bytes байт: кратна размеру страницы, а для прозрачных
+    // больших страниц — 2 МиБ, если буфер не меньше одной такой страницы
+    size_t MappingLength(size_t bytes) const noexcept {
+        const size_t granule = Granule(bytes);
+        return bytes > SIZE_MAX - granule ? SIZE_MAX : (bytes + granule - 1) / granule * granule;
+    }
+
+    void* Map(size_t length) const {
+        void* p = MAP_FAILED;
+        if (options_.pages != LargePageKind::kTransparent) {
+            const int huge_shift = options_.pages == LargePageKind::kHuge1G ? 30 : 21;
+            p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE
+                       , MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (huge_shift << MAP_HUGE_SHIFT), -1, 0);
+        }
+        if (p == MAP_FAILED) {
+            // Явных больших страниц нет в пуле: обычное отображение, выровненное по 2 МиБ
+            p = MapAligned(length);
+        }
+        Place(p, length);
+        return p;
+    }
+
+    void Unmap(void* p, size_t length) const noexcept {
+        ::munmap(p, length);
+    }
+
+    // Увеличивает отображение на месте, если за ним свободно адресное пространство
+    bool Expand(void* p, size_t old_length, size_t new_length) const noexcept {
+        if (old_length == new_length) {
+            return true;
+        }
+        if (::mremap(p, old_length, new_length, 0) == MAP_FAILED) {
+            return false;
+        }
+        Place(p, new_length);
+        return true;
+    }
+
+    // Перемещает отображение, меняя таблицы страниц вместо копирования данных
+    void* Remap(void* p, size_t old_length, size_t new_length) const noexcept {
+        void* result = ::mremap(p, old_length, new_length, MREMAP_MAYMOVE);
+        if (result == MAP_FAILED) {
+            return nullptr;
+        }
+        Place(result, new_length);
+        return result;
+    }
+
+    const LargePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+private:
+    size_t Granule(size_t bytes) const noexcept {
+        switch (options_.pages) {
+            case LargePageKind::kHuge1G:
+                return kHugePage1G;
+            case LargePageKind::kHuge2M:
+                return kHugePage2M;
+            case LargePageKind::kTransparent:
+                break;
+        }
+        return bytes >= kHugePage2M ? kHugePage2M : static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    }
+
+    // Большая страница используется, только если диапазон 2 МиБ выровнен по её размеру,
+    // поэтому отображение берётся с запасом и обрезается
+    void* MapAligned(size_t length) const {
+        const size_t alignment = length >= kHugePage2M ? kHugePage2M : 0;
+        void* p = ::mmap(nullptr, length + alignment, PROT_READ | PROT_WRITE
+                         , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (alignment == 0) {
+            return p;
+        }
+        char* begin = static_cast<char*>(p);
+        const auto address = reinterpret_cast<std::uintptr_t>(begin);
+        const size_t head = (alignment - address % alignment) % alignment;
+        if (head != 0) {
+            ::munmap(begin, head);
+        }
+        if (alignment != head) {
+            ::munmap(begin + head + length, alignment - head);
+        }
+        return begin + head;
+    }
+
+    // Советы ядру о страницах и узлах. Отображение ещё не тронуто, поэтому mbind
+    // действует на все его страницы. Ошибки игнорируются: это лишь подсказки
+    void Place(void* p, size_t length) const noexcept {
+        if (options_.pages == LargePageKind::kTransparent) {
+            ::madvise(p, length, MADV_HUGEPAGE);
+        }
+        if (options_.numa != NumaPolicy::kDefault && options_.node_mask != 0) {
+            const int mode = options_.numa == NumaPolicy::kBind ? kMpolBind : kMpolInterleave;
+            const unsigned long mask = options_.node_mask;
+            ::syscall(SYS_mbind, p, length, mode, &mask, sizeof(mask) * 8, 0);
+        }
+    }
+
+    LargePageOptions options_;
+};
+
+}  // namespace detail
+
+// Аллокатор для больших буферов: блоки от threshold_bytes отображаются через mmap
+// на большие страницы и размещаются по узлам NUMA согласно LargePageOptions,
+// меньшие блоки выделяются через operator new.
+// Поддерживает расширения RawMemory: allocate_at_least отдаёт всю длину отображения,
+// try_expand и reallocate используют mremap, поэтому рост вектора тривиально перемещаемых
+// элементов не копирует данные. Аллокатор распространяется при перемещении и обмене
+// вместе с буфером; аллокаторы с разными настройками не равны
+template <typename T>
+class LargePageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    LargePageAllocator() noexcept
+        : LargePageAllocator(LargePageOptions{}) {
+    }
+
+    explicit LargePageAllocator(const LargePageOptions& options) noexcept
+        : mapper_(options) {
+    }
+
+    template <typename U>
+    LargePageAllocator(const LargePageAllocator<U>& other) noexcept
+        : mapper_(other.GetOptions()) {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = Bytes(n);
+        if (!mapper_.IsLarge(bytes)) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(mapper_.Map(mapper_.MappingLength(bytes)));
+    }
+
+    auto allocate_at_least(size_t n) {
+        struct Result {
+            T* ptr;
+            size_t count;
+        };
+        T* p = allocate(n);
+        const size_t bytes = Bytes(n);
+        if (!mapper_.IsLarge(bytes)) {
+            return Result{p, n};
+        }
+        // deallocate восстанавливает длину отображения по числу элементов,
+        // поэтому хвост отображения отдаётся, только если длина при этом не изменится
+        const size_t length = mapper_.MappingLength(bytes);
+        const size_t count = length / sizeof(T);
+        return Result{p, mapper_.MappingLength(count * sizeof(T)) == length ? count : n};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!mapper_.IsLarge(bytes)) {
+            std::allocator<T>().deallocate(p, n);
+        } else {
+            mapper_.Unmap(p, mapper_.MappingLength(bytes));
+        }
+    }
+
+    bool try_expand(T* p, size_t old_n, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)
+            || !mapper_.IsLarge(old_n * sizeof(T))) {
+            return false;
+        }
+        return mapper_.Expand(p, mapper_.MappingLength(old_n * sizeof(T))
+                              , mapper_.MappingLength(new_n * sizeof(T)));
+    }
+
+    T* reallocate(T* p, size_t old_n, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = new_n * sizeof(T);
+        if (mapper_.IsLarge(old_bytes) && mapper_.IsLarge(new_bytes)) {
+            return static_cast<T*>(mapper_.Remap(p, mapper_.MappingLength(old_bytes)
+                                                 , mapper_.MappingLength(new_bytes)));
+        }
+        // Буфер переходит через порог: данные переносятся в новый блок
+        T* result = nullptr;
+        try {
+            result = allocate(new_n);
+        } catch (...) {
+            return nullptr;
+        }
+        std::memcpy(static_cast<void*>(result), static_cast<const void*>(p), std::min(old_bytes, new_bytes));
+        deallocate(p, old_n);
+        return result;
+    }
+
+    const LargePageOptions& GetOptions() const noexcept {
+        return mapper_.GetOptions();
+    }
+
+    template <typename U>
+    bool operator==(const LargePageAllocator<U>& other) const noexcept {
+        return GetOptions() == other.GetOptions();
+    }
+
+    template <typename U>
+    bool operator!=(const LargePageAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    static size_t Bytes(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    detail::LargePageMapper mapper_;
+};
+
+template <typename T>
+using LargePageVector = Vector<T, LargePageAllocator<T>>;
+
+#endif  // __linux__
+
+template <typename T>
+using MallocVector = Vector<T, MallocAllocator<T>>;
+
+template <typename T, size_t Alignment = 64>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>>;
+
+template <typename T>
+using RecyclingVector = Vector<T, RecyclingAllocator<T>>;
+
+template <typename T>
+using ArenaAllocator = ResourceAllocator<T, BumpArena>;
+
+template <typename T>
+using PoolAllocator = ResourceAllocator<T, PoolResource>;
+
+template <typename T>
+using ArenaVector = Vector<T, ArenaAllocator<T>>;
+
+template <typename T>
+using PoolVector = Vector<T, PoolAllocator<T>>;
@@ -0,0 +1,435 @@
+// Сравнение производительности Vector с std::vector, boost::container::vector и folly::fbvector.
+//
+// Сборка (Google Benchmark, boost и folly — необязательные зависимости):
+//     g++ -O2 -std=c++17 -I.. benchmark.cpp -lbenchmark -lpthread -o benchmark
+// По умолчанию результаты выводятся в JSON; остальные флаги Google Benchmark работают как обычно:
+//     ./benchmark --benchmark_filter='PushBack/Vector<int>' --benchmark_out=bench.json
+#include "vector.h"
+#include "vector_simd.h"
+#include "flat_map.h"
+#include "counting.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if __has_include(<boost/container/vector.hpp>)
+#include <boost/container/vector.hpp>
+#define VECTOR_BENCH_HAS_BOOST 1
+#endif
+
+#if __has_include(<folly/FBVector.h>)
+#include <folly/FBVector.h>
+#define VECTOR_BENCH_HAS_FOLLY 1
+#endif
+
+// Обращения к глобальному operator new считает counting.h; benchmark сообщает их как allocs_per_op
+using counting::num_allocations;
+
+namespace {
+
+// Тривиальная структура размером в кэш-линию
+struct Pod64 {
+    uint64_t fields[8];
+};
+
+// Тип с потенциально бросающими копированием и перемещением: векторы вынуждены копировать его
+// при реаллокации, чтобы сохранить строгую гарантию
+struct ThrowingCopy {
+    ThrowingCopy() = default;
+    explicit ThrowingCopy(int value)
+        : value(value) {
+    }
+    ThrowingCopy(const ThrowingCopy& other)
+        : value(other.value) {
+        if (value < 0) {
+            throw std::runtime_error("negative value");
+        }
+    }
+    ThrowingCopy(ThrowingCopy&& other) noexcept(false)
+        : value(other.value) {
+    }
+    ThrowingCopy& operator=(const ThrowingCopy&) = default;
+    ThrowingCopy& operator=(ThrowingCopy&&) = default;
+
+    int value = 0;
+};
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return "a string long enough to allocate " + std::to_string(i);
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        return Pod64{{i, i, i, i, i, i, i, i}};
+    } else {
+        return T(static_cast<int>(i));
+    }
+}
+
+// Единый интерфейс к сравниваемым контейнерам
+template <typename T, typename Alloc, typename Growth>
+void PushBack(Vector<T, Alloc, Growth>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename C, typename T>
+void PushBack(C& v, const T& value) {
+    v.push_back(value);
+}
+
+template <typename T, typename Alloc, typename Growth>
+void Reserve(Vector<T, Alloc, Growth>& v, size_t n) {
+    v.Reserve(n);
+}
+
+template <typename C>
+void Reserve(C& v, size_t n) {
+    v.reserve(n);
+}
+
+template <typename T, typename Alloc, typename Growth>
+void Insert(Vector<T, Alloc, Growth>& v, size_t pos, const T& value) {
+    v.Insert(v.cbegin() + pos, value);
+}
+
+template <typename C, typename T>
+void Insert(C& v, size_t pos, const T& value) {
+    v.insert(v.cbegin() + static_cast<std::ptrdiff_t>(pos), value);
+}
+
+template <typename T, typename Alloc, typename Growth>
+void Erase(Vector<T, Alloc, Growth>& v, size_t pos) {
+    v.Erase(v.cbegin() + pos);
+}
+
+template <typename C>
+void Erase(C& v, size_t pos) {
+    v.erase(v.cbegin() + static_cast<std::ptrdiff_t>(pos));
+}
+
+template <typename T, typename Alloc, typename Growth, typename Pred>
+void EraseIf(Vector<T, Alloc, Growth>& v, Pred pred) {
+    v.EraseIf(pred);
+}
+
+template <typename C, typename Pred>
+void EraseIf(C& v, Pred pred) {
+    v.erase(std::remove_if(v.begin(), v.end(), pred), v.end());
+}
+
+template <typename T, typename Alloc, typename Growth>
+size_t Size(const Vector<T, Alloc, Growth>& v) {
+    return v.Size();
+}
+
+template <typename C>
+size_t Size(const C& v) {
+    return v.size();
+}
+
+template <typename C>
+C MakeFilled(size_t n) {
+    using T = typename C::value_type;
+    C v;
+    Reserve(v, n);
+    for (size_t i = 0; i < n; ++i) {
+        PushBack(v, MakeValue<T>(i));
+    }
+    return v;
+}
+
+void SetItemCounters(benchmark::State& state, size_t allocations_before) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(num_allocations - allocations_before)
+        , benchmark::Counter::kAvgIterations);
+}
+
+// Заполнение пустого контейнера n элементами без предварительного Reserve
+template <typename C>
+void BM_PushBack(benchmark::State& state) {
+    using T = typename C::value_type;
+    const auto n = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    for (auto _ : state) {
+        C v;
+        for (size_t i = 0; i < n; ++i) {
+            PushBack(v, value);
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Перенос n элементов в буфер вдвое большей ёмкости
+template <typename C>
+void BM_Reserve(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        C v = MakeFilled<C>(n);
+        state.ResumeTiming();
+        Reserve(v, n * 2);
+        benchmark::DoNotOptimize(v);
+        state.PauseTiming();
+        v = C();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Вставка одного элемента в позицию pos_num / pos_den от размера. Контейнер растёт от n до 2n,
+// затем вне замера возвращается к размеру n
+template <typename C, size_t PosNum, size_t PosDen>
+void BM_Emplace(benchmark::State& state) {
+    using T = typename C::value_type;
+    const auto n = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    C v = MakeFilled<C>(n);
+    Reserve(v, n * 2 + 1);
+    const size_t allocations_before = num_allocations;
+    size_t paused_allocations = 0;
+    for (auto _ : state) {
+        Insert(v, Size(v) * PosNum / PosDen, value);
+        if (Size(v) >= n * 2) {
+            state.PauseTiming();
+            const size_t before = num_allocations;
+            v = MakeFilled<C>(n);
+            Reserve(v, n * 2 + 1);
+            paused_allocations += num_allocations - before;
+            state.ResumeTiming();
+        }
+    }
+    SetItemCounters(state, allocations_before + paused_allocations);
+}
+
+// Удаление из середины. Контейнер уменьшается от 2n до n, затем вне замера заполняется заново
+template <typename C>
+void BM_Erase(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    C v = MakeFilled<C>(n * 2);
+    for (auto _ : state) {
+        Erase(v, Size(v) / 2);
+        if (Size(v) <= n) {
+            state.PauseTiming();
+            v = MakeFilled<C>(n * 2);
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Удаление каждого второго элемента за один проход; заполнение вне замера
+template <typename C>
+void BM_EraseIf(benchmark::State& state) {
+    using T = typename C::value_type;
+    const auto n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        C v = MakeFilled<C>(n);
+        size_t index = 0;
+        state.ResumeTiming();
+        EraseIf(v, [&index](const T&) {
+            return index++ % 2 == 1;
+        });
+        benchmark::DoNotOptimize(v);
+        state.PauseTiming();
+        v = C();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Копирующее присваивание в контейнер, ёмкости которого достаточно
+template <typename C>
+void BM_CopyAssign(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const C source = MakeFilled<C>(n);
+    C target = MakeFilled<C>(n);
+    for (auto _ : state) {
+        target = source;
+        benchmark::DoNotOptimize(target);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Последовательный проход по элементам
+template <typename C>
+void BM_Iterate(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const C v = MakeFilled<C>(n);
+    for (auto _ : state) {
+        for (const auto& item : v) {
+            benchmark::DoNotOptimize(&item);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Верхняя граница размеров: 10^8 элементов, но не больше 1 ГиБ данных.
+// Операции со сдвигом хвоста стоят O(n) на вызов, для них граница 10^6
+constexpr int64_t kMaxElements = 100'000'000;
+constexpr int64_t kMaxBytes = int64_t{1} << 30;
+constexpr int64_t kMaxShiftElements = 1'000'000;
+
+template <typename C>
+void RegisterContainer(std::string_view container_name, std::string_view type_name) {
+    using T = typename C::value_type;
+    const int64_t max_n = std::min<int64_t>(kMaxElements, kMaxBytes / static_cast<int64_t>(sizeof(T)));
+    const int64_t max_shift_n = std::min(max_n, kMaxShiftElements);
+    const std::string suffix = std::string(container_name) + "<" + std::string(type_name) + ">";
+
+    auto add = [&](std::string_view op, void (*fn)(benchmark::State&), int64_t max) {
+        const std::string name = std::string(op) + "/" + suffix;
+        benchmark::RegisterBenchmark(name.c_str(), fn)->RangeMultiplier(10)->Range(1, max);
+    };
+    add("PushBack", BM_PushBack<C>, max_n);
+    add("Reserve", BM_Reserve<C>, max_n);
+    add("EmplaceFront", BM_Emplace<C, 0, 1>, max_shift_n);
+    add("EmplaceMiddle", BM_Emplace<C, 1, 2>, max_shift_n);
+    add("EmplaceBack", BM_Emplace<C, 1, 1>, max_n);
+    add("Erase", BM_Erase<C>, max_shift_n);
+    add("EraseIf", BM_EraseIf<C>, max_n);
+    add("CopyAssign", BM_CopyAssign<C>, max_n);
+    add("Iterate", BM_Iterate<C>, max_n);
+}
+
+template <typename T>
+void RegisterType(std::string_view type_name) {
+    RegisterContainer<Vector<T>>("Vector", type_name);
+    RegisterContainer<std::vector<T>>("std::vector", type_name);
+#ifdef VECTOR_BENCH_HAS_BOOST
+    RegisterContainer<boost::container::vector<T>>("boost::container::vector", type_name);
+#endif
+#ifdef VECTOR_BENCH_HAS_FOLLY
+    RegisterContainer<folly::fbvector<T>>("folly::fbvector", type_name);
+#endif
+}
+
+}  // namespace
+
+// Подсчёт и сумма по столбцу Vector<uint32_t> на каждом доступном наборе инструкций
+// в сравнении с std::count и std::accumulate
+template <SimdLevel Level>
+void BM_SimdScan(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const Vector<uint32_t> v = MakeFilled<Vector<uint32_t>>(n);
+    if (SetSimdLevel(Level) != Level) {
+        state.SkipWithError("instruction set is not available");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simd::Count(v, 7u));
+        benchmark::DoNotOptimize(simd::Sum(v));
+    }
+    SetSimdLevel(DetectSimdLevel());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(uint32_t) * 2));
+}
+
+void BM_StdScan(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const Vector<uint32_t> v = MakeFilled<Vector<uint32_t>>(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::count(v.begin(), v.end(), 7u));
+        benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), uint32_t{0}));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(uint32_t) * 2));
+}
+
+void RegisterSimd() {
+    const auto add = [](const char* name, void (*fn)(benchmark::State&)) {
+        benchmark::RegisterBenchmark(name, fn)->RangeMultiplier(100)->Range(100, kMaxElements);
+    };
+    add("Scan/std", BM_StdScan);
+    add("Scan/Scalar", BM_SimdScan<SimdLevel::kScalar>);
+#if defined(VECTOR_SIMD_X86)
+    add("Scan/SSE2", BM_SimdScan<SimdLevel::kSse2>);
+    add("Scan/AVX2", BM_SimdScan<SimdLevel::kAvx2>);
+    add("Scan/AVX512", BM_SimdScan<SimdLevel::kAvx512>);
+#elif defined(VECTOR_SIMD_NEON)
+    add("Scan/NEON", BM_SimdScan<SimdLevel::kNeon>);
+#endif
+}
+
+// Поиск случайных ключей в std::set и во FlatSet с разными способами поиска
+template <typename Set>
+void BM_SetFind(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    std::mt19937 random(42);
+    Vector<uint32_t> keys;
+    keys.Reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys.PushBack(static_cast<uint32_t>(random()));
+    }
+    const Set set(keys.begin(), keys.end());
+    Vector<uint32_t> probes;
+    for (size_t i = 0; i < 1024; ++i) {
+        probes.PushBack(i % 2 == 0 ? keys[random() % n] : static_cast<uint32_t>(random()));
+    }
+    size_t found = 0;
+    for (auto _ : state) {
+        for (const uint32_t key : probes) {
+            found += set.count(key);
+        }
+    }
+    benchmark::DoNotOptimize(found);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * probes.Size()));
+}
+
+// Интерфейс std::set, которым пользуется BM_SetFind
+template <typename Search>
+struct BenchFlatSet : FlatSet<uint32_t, std::less<uint32_t>, std::allocator<uint32_t>, Search> {
+    using FlatSet<uint32_t, std::less<uint32_t>, std::allocator<uint32_t>, Search>::FlatSet;
+
+    size_t count(uint32_t key) const {
+        return this->Count(key);
+    }
+};
+
+void RegisterFlat() {
+    const auto add = [](const char* name, void (*fn)(benchmark::State&)) {
+        benchmark::RegisterBenchmark(name, fn)->RangeMultiplier(16)->Range(16, 1 << 20);
+    };
+    add("SetFind/std::set", BM_SetFind<std::set<uint32_t>>);
+    add("SetFind/FlatSet", BM_SetFind<BenchFlatSet<BranchlessSearch>>);
+    add("SetFind/FlatSet<Eytzinger>", BM_SetFind<BenchFlatSet<EytzingerSearch>>);
+}
+
+int main(int argc, char** argv) {
+    RegisterType<int>("int");
+    RegisterType<std::string>("string");
+    RegisterType<Pod64>("Pod64");
+    RegisterType<ThrowingCopy>("ThrowingCopy");
+    RegisterSimd();
+    RegisterFlat();
+
+    // JSON по умолчанию, если формат не задан явно
+    std::vector<char*> args(argv, argv + argc);
+    char json_format[] = "--benchmark_format=json";
+    bool has_format = false;
+    for (int i = 1; i < argc; ++i) {
+        has_format = has_format || std::strncmp(argv[i], "--benchmark_format", 18) == 0;
+    }
+    if (!has_format) {
+        args.push_back(json_format);
+    }
+    int args_count = static_cast<int>(args.size());
+
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
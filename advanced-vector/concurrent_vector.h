@@ -0,0 +1,186 @@
+#pragma once
+#include "vector.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Вектор для одновременного добавления элементов из многих потоков.
+// Индекс нового элемента резервируется атомарным счётчиком, а элементы хранятся в сегментах
+// RawMemory удваивающегося размера: kFirstSegment, 2 * kFirstSegment, 4 * kFirstSegment...
+// Сегменты никогда не перемещаются, поэтому ссылки на элементы остаются действительными
+// всё время жизни вектора. Мьютекс захватывается только при выделении нового сегмента.
+//
+// EmplaceBack, PushBack, Reserve и operator[] для элементов, добавление которых уже
+// завершилось, можно вызывать одновременно из разных потоков. Freeze и деструктор требуют,
+// чтобы других обращений к вектору не было.
+// Если конструктор элемента выбросил исключение, его индекс остаётся пустым:
+// IsConstructed(index) возвращает false, а Freeze такие индексы пропускает
+template <typename T, typename Alloc = std::allocator<T>>
+class ConcurrentVector {
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    static constexpr size_t kFirstSegment = 32;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Destroy();
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        const size_t segment = SegmentOf(index);
+        const size_t offset = index - SegmentBase(segment);
+        T* slot = EnsureSegment(segment) + offset;
+        new (slot) T(std::forward<Args>(args)...);
+        constructed_[segment].load(std::memory_order_relaxed)[offset / kBitsPerWord].fetch_or(
+            uint64_t{1} << (offset % kBitsPerWord), std::memory_order_release);
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Заранее выделяет сегменты, вмещающие capacity элементов
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        for (size_t segment = 0; segment <= SegmentOf(capacity - 1); ++segment) {
+            EnsureSegment(segment);
+        }
+    }
+
+    // Число зарезервированных индексов, включая элементы, которые ещё строятся
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    bool IsConstructed(size_t index) const noexcept {
+        if (index >= Size()) {
+            return false;
+        }
+        const size_t segment = SegmentOf(index);
+        const std::atomic<uint64_t>* bits = constructed_[segment].load(std::memory_order_acquire);
+        if (bits == nullptr) {
+            return false;
+        }
+        const size_t offset = index - SegmentBase(segment);
+        return (bits[offset / kBitsPerWord].load(std::memory_order_acquire)
+                >> (offset % kBitsPerWord)) & 1;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(IsConstructed(index));
+        const size_t segment = SegmentOf(index);
+        return data_[segment].load(std::memory_order_acquire)[index - SegmentBase(segment)];
+    }
+
+    // Переносит построенные элементы по порядку индексов в непрерывный Vector, выделяя память
+    // один раз, и опустошает ConcurrentVector. Если перенос выбросил исключение,
+    // ConcurrentVector не изменяется
+    Vector<T, Alloc> Freeze() {
+        Vector<T, Alloc> result(alloc_);
+        const size_t size = Size();
+        result.Reserve(size);
+        for (size_t index = 0; index < size; ++index) {
+            if (IsConstructed(index)) {
+                result.EmplaceBack(std::move_if_noexcept((*this)[index]));
+            }
+        }
+        Destroy();
+        return result;
+    }
+
+private:
+    static constexpr size_t kFirstSegmentShift = 5;
+    static_assert(kFirstSegment == size_t{1} << kFirstSegmentShift);
+    static constexpr size_t kMaxSegments = 64 - kFirstSegmentShift;
+    static constexpr size_t kBitsPerWord = 64;
+
+    // Номер сегмента с элементом index: сегмент k содержит индексы
+    // [kFirstSegment * (2^k - 1), kFirstSegment * (2^(k+1) - 1))
+    static size_t SegmentOf(size_t index) noexcept {
+        return 63 - static_cast<size_t>(__builtin_clzll((index >> kFirstSegmentShift) + 1));
+    }
+
+    static size_t SegmentBase(size_t segment) noexcept {
+        return kFirstSegment * ((size_t{1} << segment) - 1);
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return kFirstSegment << segment;
+    }
+
+    T* EnsureSegment(size_t segment) {
+        if (T* data = data_[segment].load(std::memory_order_acquire)) {
+            return data;
+        }
+        std::lock_guard guard(mutex_);
+        if (T* data = data_[segment].load(std::memory_order_relaxed)) {
+            return data;
+        }
+        const size_t words = (SegmentSize(segment) + kBitsPerWord - 1) / kBitsPerWord;
+        // Пустые скобки обнуляют слова битовой карты
+        std::unique_ptr<std::atomic<uint64_t>[]> bits(new std::atomic<uint64_t>[words]());
+        segments_[segment] = RawMemory<T, Alloc>(SegmentSize(segment), alloc_);
+        constructed_[segment].store(bits.release(), std::memory_order_release);
+        data_[segment].store(segments_[segment].GetAddress(), std::memory_order_release);
+        return segments_[segment].GetAddress();
+    }
+
+    // Разрушает построенные элементы и освобождает сегменты
+    void Destroy() noexcept {
+        const size_t size = Size();
+        for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+            std::atomic<uint64_t>* bits = constructed_[segment].load(std::memory_order_relaxed);
+            if (bits == nullptr) {
+                continue;
+            }
+            T* data = data_[segment].load(std::memory_order_relaxed);
+            const size_t base = SegmentBase(segment);
+            const size_t count = size > base ? std::min(size - base, SegmentSize(segment)) : 0;
+            for (size_t offset = 0; offset < count; ++offset) {
+                if ((bits[offset / kBitsPerWord].load(std::memory_order_relaxed) >> (offset % kBitsPerWord)) & 1) {
+                    data[offset].~T();
+                }
+            }
+            delete[] bits;
+            constructed_[segment].store(nullptr, std::memory_order_relaxed);
+            data_[segment].store(nullptr, std::memory_order_relaxed);
+            segments_[segment] = RawMemory<T, Alloc>(alloc_);
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    [[no_unique_address]] Alloc alloc_;
+    std::atomic<size_t> size_ = 0;
+    std::array<std::atomic<T*>, kMaxSegments> data_{};
+    std::array<std::atomic<std::atomic<uint64_t>*>, kMaxSegments> constructed_{};
+    std::array<RawMemory<T, Alloc>, kMaxSegments> segments_;
+    std::mutex mutex_;
+};
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Средства тестов и бенчмарков: подсчёт обращений к глобальному operator new, тип элемента
+// со счётчиками операций, бюджеты стоимости операций и дифференциальное тестирование
+// против std::vector. Заголовок заменяет глобальные operator new и operator delete,
+// поэтому включается ровно в одну единицу трансляции программы
+namespace counting {
+
+// Число обращений к глобальному operator new с начала работы программы
+inline std::atomic<size_t> num_allocations = 0;
+
+// Сколько раз вызывались конструкторы, присваивания и деструктор Counted
+struct ElementCounters {
+    size_t constructed = 0;  // конструкторы, кроме копирования и перемещения
+    size_t copied = 0;
+    size_t moved = 0;
+    size_t copy_assigned = 0;
+    size_t move_assigned = 0;
+    size_t destroyed = 0;
+
+    // Число живых объектов: построенных, но ещё не разрушенных
+    std::ptrdiff_t Alive() const noexcept {
+        return static_cast<std::ptrdiff_t>(constructed + copied + moved)
+            - static_cast<std::ptrdiff_t>(destroyed);
+    }
+};
+
+// Элемент, считающий свои операции. Перемещение noexcept, поэтому Vector перемещает
+// Counted при перевыделении, а не копирует. Не тривиально перемещаем: Vector обращается
+// с ним как с произвольным классом
+struct Counted {
+    Counted() noexcept {
+        ++counters.constructed;
+    }
+
+    explicit Counted(int value) noexcept
+        : value(value)
+    {
+        ++counters.constructed;
+    }
+
+    Counted(const Counted& other) noexcept
+        : value(other.value)
+    {
+        ++counters.copied;
+    }
+
+    Counted(Counted&& other) noexcept
+        : value(other.value)
+    {
+        ++counters.moved;
+    }
+
+    Counted& operator=(const Counted& other) noexcept {
+        value = other.value;
+        ++counters.copy_assigned;
+        return *this;
+    }
+
+    Counted& operator=(Counted&& other) noexcept {
+        value = other.value;
+        ++counters.move_assigned;
+        return *this;
+    }
+
+    ~Counted() {
+        ++counters.destroyed;
+    }
+
+    friend bool operator==(const Counted& lhs, const Counted& rhs) noexcept {
+        return lhs.value == rhs.value;
+    }
+
+    friend bool operator!=(const Counted& lhs, const Counted& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    static void ResetCounters() noexcept {
+        counters = ElementCounters();
+    }
+
+    int value = 0;
+
+    static inline ElementCounters counters;
+};
+
+// Стоимость операции: обращения к operator new и операции над элементами Counted
+struct OperationCost {
+    size_t allocations = 0;
+    size_t constructions = 0;  // все конструкторы, включая копирование и перемещение
+    size_t copies = 0;
+    size_t moves = 0;
+    size_t assignments = 0;
+    size_t destructions = 0;
+};
+
+template <typename F>
+OperationCost Measure(F&& operation) {
+    const size_t allocations = num_allocations;
+    const ElementCounters before = Counted::counters;
+    std::forward<F>(operation)();
+    const ElementCounters& after = Counted::counters;
+
+    OperationCost cost;
+    cost.allocations = num_allocations - allocations;
+    cost.copies = after.copied - before.copied;
+    cost.moves = after.moved - before.moved;
+    cost.constructions = after.constructed - before.constructed + cost.copies + cost.moves;
+    cost.assignments = after.copy_assigned - before.copy_assigned
+        + after.move_assigned - before.move_assigned;
+    cost.destructions = after.destroyed - before.destroyed;
+    return cost;
+}
+
+// Верхние границы стоимости операции. Не заданная граница не ограничивает
+class Budget {
+public:
+    static constexpr size_t kUnlimited = SIZE_MAX;
+
+    Budget& Allocations(size_t n) noexcept {
+        limit_.allocations = n;
+        return *this;
+    }
+
+    Budget& Constructions(size_t n) noexcept {
+        limit_.constructions = n;
+        return *this;
+    }
+
+    Budget& Copies(size_t n) noexcept {
+        limit_.copies = n;
+        return *this;
+    }
+
+    Budget& Moves(size_t n) noexcept {
+        limit_.moves = n;
+        return *this;
+    }
+
+    Budget& Assignments(size_t n) noexcept {
+        limit_.assignments = n;
+        return *this;
+    }
+
+    Budget& Destructions(size_t n) noexcept {
+        limit_.destructions = n;
+        return *this;
+    }
+
+    // Описание первой превышенной границы или пустая строка
+    std::string Violation(const OperationCost& cost) const {
+        const std::pair<const char*, std::pair<size_t, size_t>> checks[] = {
+            {"allocations", {cost.allocations, limit_.allocations}},
+            {"constructions", {cost.constructions, limit_.constructions}},
+            {"copies", {cost.copies, limit_.copies}},
+            {"moves", {cost.moves, limit_.moves}},
+            {"assignments", {cost.assignments, limit_.assignments}},
+            {"destructions", {cost.destructions, limit_.destructions}},
+        };
+        for (const auto& [name, values] : checks) {
+            if (values.first > values.second) {
+                return std::string(name) + " " + std::to_string(values.first) + " > "
+                    + std::to_string(values.second);
+            }
+        }
+        return {};
+    }
+
+private:
+    OperationCost limit_{kUnlimited, kUnlimited, kUnlimited, kUnlimited, kUnlimited, kUnlimited};
+};
+
+class BudgetExceeded : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Выполняет операцию и выбрасывает BudgetExceeded, если её стоимость превысила бюджет.
+// В отличие от assert проверка остаётся и с NDEBUG: регрессия видна в оптимизированной сборке
+template <typename F>
+OperationCost CheckBudget(std::string_view name, const Budget& budget, F&& operation) {
+    const OperationCost cost = Measure(std::forward<F>(operation));
+    const std::string violation = budget.Violation(cost);
+    if (!violation.empty()) {
+        throw BudgetExceeded(std::string(name) + ": " + violation);
+    }
+    return cost;
+}
+
+// Выполняет steps случайных операций одновременно над вектором V и над std::vector
+// и после каждой сравнивает содержимое. При расхождении выбрасывает std::logic_error
+// с зерном, номером шага и операцией: тот же seed воспроизводит ту же последовательность.
+// Элементы V строятся из int и сравниваются ==; размер держится около max_size
+template <typename V>
+void FuzzAgainstStdVector(uint32_t seed, size_t steps, size_t max_size = 64) {
+    using T = typename V::value_type;
+    enum Operation {
+        kPushBack, kPushBackAlias, kEmplaceBack, kPopBack, kInsert, kInsertAlias, kInsertCount,
+        kInsertRange, kErase, kEraseRange, kEraseIf, kResize, kReserve, kShrinkToFit, kClear,
+        kCopy, kMove, kSwap, kOperationCount,
+    };
+    static constexpr const char* kNames[kOperationCount] = {
+        "PushBack", "PushBack(alias)", "EmplaceBack", "PopBack", "Insert", "Insert(alias)",
+        "Insert(count)", "Insert(range)", "Erase", "Erase(range)", "EraseIf", "Resize", "Reserve",
+        "ShrinkToFit", "Clear", "copy", "move", "Swap",
+    };
+
+    std::mt19937 random(seed);
+    const auto uniform = [&random](size_t n) {
+        return std::uniform_int_distribution<size_t>(0, n)(random);
+    };
+    V v;
+    std::vector<T> model;
+    int next = 0;
+
+    for (size_t step = 0; step < steps; ++step) {
+        const size_t size = model.size();
+        auto op = static_cast<Operation>(uniform(kOperationCount - 1));
+        if (size >= max_size && op < kErase) {
+            op = kEraseRange;
+        }
+        if (size == 0 && (op == kPushBackAlias || op == kPopBack || op == kInsertAlias || op == kErase
+                          || op == kEraseIf)) {
+            op = kPushBack;
+        }
+        // Для Clear шаг выбирается ещё раз, иначе вектор почти всё время короткий
+        if (op == kClear && uniform(3) != 0) {
+            op = kReserve;
+        }
+
+        switch (op) {
+        case kPushBack: {
+            const T value(next++);
+            v.PushBack(value);
+            model.push_back(value);
+            break;
+        }
+        case kPushBackAlias: {
+            // Аргумент ссылается на элемент самого вектора, который может перевыделиться
+            const size_t index = uniform(size - 1);
+            v.PushBack(v[index]);
+            model.push_back(T(model[index]));
+            break;
+        }
+        case kEmplaceBack:
+            v.EmplaceBack(next);
+            model.emplace_back(next++);
+            break;
+        case kPopBack:
+            v.PopBack();
+            model.pop_back();
+            break;
+        case kInsert: {
+            const size_t index = uniform(size);
+            v.Insert(v.begin() + index, T(next));
+            model.insert(model.begin() + index, T(next++));
+            break;
+        }
+        case kInsertAlias: {
+            const size_t index = uniform(size);
+            const size_t source = uniform(size - 1);
+            v.Insert(v.begin() + index, v[source]);
+            model.insert(model.begin() + index, T(model[source]));
+            break;
+        }
+        case kInsertCount: {
+            const size_t index = uniform(size);
+            const size_t count = uniform(std::min<size_t>(8, max_size - size));
+            const T value(next++);
+            v.Insert(v.begin() + index, count, value);
+            model.insert(model.begin() + index, count, value);
+            break;
+        }
+        case kInsertRange: {
+            const size_t index = uniform(size);
+            std::vector<T> source;
+            for (size_t i = uniform(std::min<size_t>(8, max_size - size)); i > 0; --i) {
+                source.emplace_back(next++);
+            }
+            v.Insert(v.begin() + index, source.begin(), source.end());
+            model.insert(model.begin() + index, source.begin(), source.end());
+            break;
+        }
+        case kErase: {
+            const size_t index = uniform(size - 1);
+            v.Erase(v.begin() + index);
+            model.erase(model.begin() + index);
+            break;
+        }
+        case kEraseRange: {
+            const size_t first = uniform(size);
+            const size_t last = first + uniform(size - first);
+            v.Erase(v.begin() + first, v.begin() + last);
+            model.erase(model.begin() + first, model.begin() + last);
+            break;
+        }
+        case kEraseIf: {
+            // Удаляются все копии случайного элемента: их даёт PushBack(alias) и Insert(alias)
+            const T target = model[uniform(size - 1)];
+            const auto pred = [&target](const T& value) {
+                return value == target;
+            };
+            v.EraseIf(pred);
+            model.erase(std::remove_if(model.begin(), model.end(), pred), model.end());
+            break;
+        }
+        case kResize: {
+            const size_t new_size = uniform(max_size);
+            v.Resize(new_size);
+            model.resize(new_size);
+            break;
+        }
+        case kReserve:
+            v.Reserve(uniform(max_size * 2));
+            break;
+        case kShrinkToFit:
+            v.ShrinkToFit();
+            break;
+        case kClear:
+            v.Clear();
+            model.clear();
+            break;
+        case kCopy: {
+            const V copy(v);
+            v = copy;
+            break;
+        }
+        case kMove: {
+            V moved(std::move(v));
+            v = std::move(moved);
+            break;
+        }
+        case kSwap: {
+            V other;
+            other.Swap(v);
+            v.Swap(other);
+            break;
+        }
+        case kOperationCount:
+            break;
+        }
+
+        bool equal = v.Size() == model.size() && v.Capacity() >= v.Size();
+        for (size_t i = 0; equal && i < model.size(); ++i) {
+            equal = v[i] == model[i];
+        }
+        if (!equal) {
+            throw std::logic_error("FuzzAgainstStdVector: seed " + std::to_string(seed) + ", step "
+                                   + std::to_string(step) + ", " + kNames[op] + ": contents differ");
+        }
+    }
+}
+
+}  // namespace counting
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++counting::num_allocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Через nothrow-версию выделяют временные буферы std::stable_sort и std::inplace_merge
+[[gnu::noinline]] void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++counting::num_allocations;
+    return std::malloc(size != 0 ? size : 1);
+}
+
+// noinline: иначе GCC видит free для памяти из operator new и выдаёт -Wmismatched-new-delete
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
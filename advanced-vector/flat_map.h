@@ -0,0 +1,508 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Упорядоченные ассоциативные контейнеры поверх Vector: ключи хранятся в одном
+// отсортированном массиве, а значения FlatMap — в отдельном, параллельном ему. Поиск
+// проходит только по плотному массиву ключей, без обхода узлов дерева.
+// Вставка и удаление одного элемента сдвигают хвост за O(n), поэтому большие наборы
+// стоит вставлять целиком: диапазон дописывается в конец, сортируется и сливается
+// с прежними элементами, а повторы отбрасываются (остаётся первый).
+// Если при этом выброшено исключение, контейнер очищается, как std::flat_map
+
+// Способ поиска. BranchlessSearch — двоичный поиск по отсортированному массиву без
+// условных переходов. EytzingerSearch дополнительно хранит копию ключей в порядке обхода
+// дерева в ширину (раскладка Эйтцингера): первые уровни дерева лежат в соседних кэш-линиях.
+// Выигрыш возможен только на наборах, не помещающихся в кэш; на малых наборах
+// BranchlessSearch быстрее. Каждое изменение перестраивает копию за O(n)
+struct BranchlessSearch {};
+struct EytzingerSearch {};
+
+namespace detail {
+
+// Индекс первого элемента [data, data + n), не меньшего key
+template <typename T, typename K, typename Compare>
+size_t BranchlessLowerBound(const T* data, size_t n, const K& key, const Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        // Тернарный оператор компилируется в условную пересылку вместо перехода
+        base = comp(base[half], key) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<size_t>(base - data) + (comp(*base, key) ? 1 : 0);
+}
+
+template <typename Key, typename Search>
+class SearchIndex;
+
+template <typename Key>
+class SearchIndex<Key, BranchlessSearch> {
+public:
+    void Rebuild(const Key* /*keys*/, size_t /*n*/) {
+    }
+
+    void Clear() noexcept {
+    }
+
+    template <typename K, typename Compare>
+    size_t LowerBound(const Key* keys, size_t n, const K& key, const Compare& comp) const {
+        return BranchlessLowerBound(keys, n, key, comp);
+    }
+};
+
+template <typename Key>
+class SearchIndex<Key, EytzingerSearch> {
+public:
+    // Раскладывает n отсортированных ключей: узел k (с единицы) хранится в tree_[k - 1],
+    // его потомки — узлы 2k и 2k + 1, а ranks_[k] — индекс ключа в отсортированном массиве
+    void Rebuild(const Key* keys, size_t n) {
+        Vector<size_t> ranks(n + 1);
+        size_t next = 0;
+        Fill(ranks, 1, next);
+        Vector<Key> tree;
+        tree.Reserve(n);
+        for (size_t k = 1; k <= n; ++k) {
+            tree.EmplaceBack(keys[ranks[k]]);
+        }
+        tree_.Swap(tree);
+        ranks_.Swap(ranks);
+    }
+
+    void Clear() noexcept {
+        tree_.ReleaseMemory();
+        ranks_.ReleaseMemory();
+    }
+
+    template <typename K, typename Compare>
+    size_t LowerBound(const Key* /*keys*/, size_t n, const K& key, const Compare& comp) const {
+        assert(tree_.Size() == n);
+        unsigned long long k = 1;
+        const Key* tree = tree_.Data();
+        while (k <= n) {
+            // Потомки на четыре уровня ниже занимают 16 соседних узлов: их кэш-линия
+            // загружается заранее, пока идут сравнения на промежуточных уровнях
+            // Адрес считается в целых числах: за пределами дерева предвыборка ничего не делает
+            __builtin_prefetch(reinterpret_cast<const void*>(
+                reinterpret_cast<uintptr_t>(tree) + (16 * k - 1) * sizeof(Key)));
+            k = 2 * k + (comp(tree[k - 1], key) ? 1 : 0);
+        }
+        // Спуск закончился правее ответа: последний поворот налево отмечен последним
+        // нулевым битом пути, и сдвиг за него возвращает к узлу-ответу
+        k >>= __builtin_ffsll(static_cast<long long>(~k));
+        return k == 0 ? n : ranks_[k];
+    }
+
+private:
+    void Fill(Vector<size_t>& ranks, size_t k, size_t& next) const noexcept {
+        const size_t n = ranks.Size() - 1;
+        if (k <= n) {
+            Fill(ranks, 2 * k, next);
+            ranks[k] = next++;
+            Fill(ranks, 2 * k + 1, next);
+        }
+    }
+
+    Vector<Key> tree_;
+    Vector<size_t> ranks_;
+};
+
+}  // namespace detail
+
+// Множество уникальных ключей в отсортированном Vector
+template <typename Key, typename Compare = std::less<Key>, typename Alloc = std::allocator<Key>
+          , typename Search = BranchlessSearch>
+class FlatSet {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp, const Alloc& alloc = Alloc())
+        : keys_(alloc)
+        , comp_(comp) {
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+        : keys_(alloc)
+        , comp_(comp) {
+        Insert(first, last);
+    }
+
+    std::pair<iterator, bool> Insert(const Key& key) {
+        return EmplaceAt(key, key);
+    }
+
+    std::pair<iterator, bool> Insert(Key&& key) {
+        return EmplaceAt(key, std::move(key));
+    }
+
+    // Вставляет ключи [first, last) одной вставкой диапазона, сортировкой и слиянием
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Insert(InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        try {
+            keys_.Append(first, last);
+            Key* begin = keys_.Data();
+            Key* middle = begin + old_size;
+            Key* end = begin + keys_.Size();
+            std::stable_sort(middle, end, comp_);
+            std::inplace_merge(begin, middle, end, comp_);
+            Key* unique_end = std::unique(begin, end, [this](const Key& lhs, const Key& rhs) {
+                return !comp_(lhs, rhs);
+            });
+            keys_.Erase(keys_.cbegin() + (unique_end - begin), keys_.cend());
+            search_.Rebuild(keys_.Data(), keys_.Size());
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    // Возвращает число удалённых ключей: 0 или 1
+    size_t Erase(const Key& key) {
+        const_iterator it = Find(key);
+        if (it == end()) {
+            return 0;
+        }
+        Erase(it);
+        return 1;
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - begin();
+        keys_.Erase(keys_.cbegin() + index);
+        RebuildIndex();
+        return begin() + index;
+    }
+
+    const_iterator Find(const Key& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return index != keys_.Size() && !comp_(key, keys_[index]) ? begin() + index : end();
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Первый ключ, не меньший key
+    const_iterator LowerBound(const Key& key) const {
+        return begin() + LowerBoundIndex(key);
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        search_.Clear();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    // Отсортированный массив ключей
+    const Vector<Key, Alloc>& Keys() const noexcept {
+        return keys_;
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.Data();
+    }
+    const_iterator end() const noexcept {
+        return keys_.Data() + keys_.Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return this->begin();
+    }
+    const_iterator cend() const noexcept {
+        return this->end();
+    }
+
+private:
+    size_t LowerBoundIndex(const Key& key) const {
+        return search_.LowerBound(keys_.Data(), keys_.Size(), key, comp_);
+    }
+
+    template <typename K>
+    std::pair<iterator, bool> EmplaceAt(const Key& key, K&& value) {
+        const size_t index = detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+        if (index != keys_.Size() && !comp_(key, keys_[index])) {
+            return {begin() + index, false};
+        }
+        keys_.Insert(keys_.cbegin() + index, std::forward<K>(value));
+        RebuildIndex();
+        return {begin() + index, true};
+    }
+
+    // Если индекс поиска не удалось перестроить, контейнер очищается,
+    // чтобы индекс не расходился с ключами
+    void RebuildIndex() {
+        try {
+            search_.Rebuild(keys_.Data(), keys_.Size());
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    Vector<Key, Alloc> keys_;
+    [[no_unique_address]] Compare comp_;
+    detail::SearchIndex<Key, Search> search_;
+};
+
+// Отображение с уникальными ключами. Ключи и значения лежат в двух параллельных Vector:
+// i-й ключ отсортированного массива Keys() соответствует значению Values()[i]
+template <typename Key, typename Value, typename Compare = std::less<Key>
+          , typename KeyAlloc = std::allocator<Key>, typename ValueAlloc = std::allocator<Value>
+          , typename Search = BranchlessSearch>
+class FlatMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using key_compare = Compare;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp, const KeyAlloc& key_alloc = KeyAlloc()
+                     , const ValueAlloc& value_alloc = ValueAlloc())
+        : keys_(key_alloc)
+        , values_(value_alloc)
+        , comp_(comp) {
+    }
+
+    // Вставляет значение, построенное из args, если ключа ещё нет. Возвращает указатель
+    // на значение ключа и признак вставки
+    template <typename... Args>
+    std::pair<Value*, bool> TryEmplace(const Key& key, Args&&... args) {
+        const size_t index = detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+        if (index != keys_.Size() && !comp_(key, keys_[index])) {
+            return {&values_[index], false};
+        }
+        values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Insert(keys_.cbegin() + index, key);
+        } catch (...) {
+            values_.Erase(values_.cbegin() + index);
+            throw;
+        }
+        RebuildIndex();
+        return {&values_[index], true};
+    }
+
+    std::pair<Value*, bool> Insert(const Key& key, const Value& value) {
+        return TryEmplace(key, value);
+    }
+
+    std::pair<Value*, bool> Insert(const Key& key, Value&& value) {
+        return TryEmplace(key, std::move(value));
+    }
+
+    // Пары (ключ, значение) из [first, last)
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Insert(InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        try {
+            for (; first != last; ++first) {
+                keys_.EmplaceBack(first->first);
+                values_.EmplaceBack(first->second);
+            }
+        } catch (...) {
+            Clear();
+            throw;
+        }
+        Normalize(old_size);
+    }
+
+    // Ключи [key_first, key_last) и столько же значений, начиная с value_first.
+    // Оба массива дописываются вставкой диапазона
+    template <typename KeyIt, typename ValueIt, typename = detail::RequireInputIterator<KeyIt>
+              , typename = detail::RequireInputIterator<ValueIt>>
+    void Insert(KeyIt key_first, KeyIt key_last, ValueIt value_first) {
+        static_assert(detail::kIsForwardIterator<KeyIt>, "key range must be a forward range");
+        const size_t old_size = keys_.Size();
+        const auto count = std::distance(key_first, key_last);
+        try {
+            keys_.Append(key_first, key_last);
+            values_.Append(value_first, std::next(value_first, count));
+        } catch (...) {
+            Clear();
+            throw;
+        }
+        Normalize(old_size);
+    }
+
+    // Значение ключа; отсутствующий ключ вставляется со значением по умолчанию
+    Value& operator[](const Key& key) {
+        return *TryEmplace(key).first;
+    }
+
+    Value& At(const Key& key) {
+        return const_cast<Value&>(std::as_const(*this).At(key));
+    }
+
+    const Value& At(const Key& key) const {
+        const Value* value = Find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("FlatMap::At: key not found");
+        }
+        return *value;
+    }
+
+    // nullptr, если ключа нет
+    Value* Find(const Key& key) {
+        return const_cast<Value*>(std::as_const(*this).Find(key));
+    }
+
+    const Value* Find(const Key& key) const {
+        const size_t index = FindIndex(key);
+        return index != keys_.Size() ? &values_[index] : nullptr;
+    }
+
+    bool Contains(const Key& key) const {
+        return FindIndex(key) != keys_.Size();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Возвращает число удалённых элементов: 0 или 1
+    size_t Erase(const Key& key) {
+        const size_t index = FindIndex(key);
+        if (index == keys_.Size()) {
+            return 0;
+        }
+        keys_.Erase(keys_.cbegin() + index);
+        values_.Erase(values_.cbegin() + index);
+        RebuildIndex();
+        return 1;
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+        values_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+        search_.Clear();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    // Отсортированный массив ключей
+    const Vector<Key, KeyAlloc>& Keys() const noexcept {
+        return keys_;
+    }
+
+    // Значения в порядке ключей. Их можно изменять, но не добавлять и не удалять
+    Vector<Value, ValueAlloc>& Values() noexcept {
+        return values_;
+    }
+
+    const Vector<Value, ValueAlloc>& Values() const noexcept {
+        return values_;
+    }
+
+private:
+    // Индекс ключа или Size(), если его нет
+    size_t FindIndex(const Key& key) const {
+        const size_t index = search_.LowerBound(keys_.Data(), keys_.Size(), key, comp_);
+        return index != keys_.Size() && !comp_(key, keys_[index]) ? index : keys_.Size();
+    }
+
+    // Упорядочивает дописанные после old_size элементы и сливает их с прежними.
+    // Сортируется перестановка индексов, после чего ключи и значения переносятся
+    // в новые массивы за один проход
+    void Normalize(size_t old_size) {
+        try {
+            const size_t n = keys_.Size();
+            Vector<size_t> order(n);
+            for (size_t i = 0; i < n; ++i) {
+                order[i] = i;
+            }
+            const auto by_key = [this](size_t lhs, size_t rhs) {
+                return comp_(keys_[lhs], keys_[rhs]);
+            };
+            size_t* first = order.Data();
+            size_t* middle = first + old_size;
+            size_t* last = first + n;
+            std::stable_sort(middle, last, by_key);
+            std::inplace_merge(first, middle, last, by_key);
+            size_t* unique_end = std::unique(first, last, [this](size_t lhs, size_t rhs) {
+                return !comp_(keys_[lhs], keys_[rhs]);
+            });
+
+            const size_t unique_count = static_cast<size_t>(unique_end - first);
+            bool in_place = unique_count == n;
+            for (size_t i = 0; in_place && i < n; ++i) {
+                in_place = order[i] == i;
+            }
+            if (!in_place) {
+                Vector<Key, KeyAlloc> keys(keys_.GetAllocator());
+                Vector<Value, ValueAlloc> values(values_.GetAllocator());
+                keys.Reserve(unique_count);
+                values.Reserve(unique_count);
+                for (const size_t* it = first; it != unique_end; ++it) {
+                    keys.EmplaceBack(std::move(keys_[*it]));
+                    values.EmplaceBack(std::move(values_[*it]));
+                }
+                keys_.Swap(keys);
+                values_.Swap(values);
+            }
+            search_.Rebuild(keys_.Data(), keys_.Size());
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    void RebuildIndex() {
+        try {
+            search_.Rebuild(keys_.Data(), keys_.Size());
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    Vector<Key, KeyAlloc> keys_;
+    Vector<Value, ValueAlloc> values_;
+    [[no_unique_address]] Compare comp_;
+    detail::SearchIndex<Key, Search> search_;
+};
@@ -0,0 +1,334 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Ячейки InplaceVector: встроенный буфер на N элементов и число построенных в его начале
+template <typename T, size_t N>
+class InplaceSlots {
+public:
+    T* GetAddress() noexcept {
+        return reinterpret_cast<T*>(storage_);
+    }
+
+    const T* GetAddress() const noexcept {
+        return reinterpret_cast<const T*>(storage_);
+    }
+
+protected:
+    // Присваивает n элементов, начиная с first, по правилам Vector::Assign:
+    // общая часть присваивается, недостающие элементы создаются, лишние разрушаются
+    template <typename InputIt>
+    void AssignN(InputIt first, size_t n) {
+        assert(n <= N);
+        T* data = GetAddress();
+        const size_t common = std::min(size_, n);
+        for (size_t i = 0; i < common; ++i, ++first) {
+            data[i] = *first;
+        }
+        if (n > size_) {
+            UninitializedCopyN(first, n - size_, data + size_);
+        } else {
+            std::destroy_n(data + n, size_ - n);
+        }
+        size_ = n;
+    }
+
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+    size_t size_ = 0;
+};
+
+// Для тривиально копируемых T копирование и разрушение буфера остаются тривиальными,
+// поэтому InplaceVector тоже тривиально копируем
+template <typename T, size_t N, bool = std::is_trivially_copyable_v<T>>
+class InplaceStorage : public InplaceSlots<T, N> {};
+
+// Остальные типы копируются и разрушаются поштучно, только в построенных ячейках
+template <typename T, size_t N>
+class InplaceStorage<T, N, false> : public InplaceSlots<T, N> {
+public:
+    InplaceStorage() = default;
+
+    InplaceStorage(const InplaceStorage& other) {
+        UninitializedCopyN(other.GetAddress(), other.size_, this->GetAddress());
+        this->size_ = other.size_;
+    }
+
+    // Элементы перемещаются поштучно, исходный вектор сохраняет размер,
+    // а его элементы остаются в состоянии после перемещения
+    InplaceStorage(InplaceStorage&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        UninitializedMoveN(other.GetAddress(), other.size_, this->GetAddress());
+        this->size_ = other.size_;
+    }
+
+    InplaceStorage& operator=(const InplaceStorage& rhs) {
+        if (this != &rhs) {
+            this->AssignN(rhs.GetAddress(), rhs.size_);
+        }
+        return *this;
+    }
+
+    InplaceStorage& operator=(InplaceStorage&& rhs) noexcept(
+        std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            this->AssignN(std::make_move_iterator(rhs.GetAddress()), rhs.size_);
+        }
+        return *this;
+    }
+
+    ~InplaceStorage() {
+        std::destroy_n(this->GetAddress(), this->size_);
+    }
+};
+
+}  // namespace detail
+
+// Вектор фиксированной ёмкости N, хранящий элементы только во встроенном буфере, как
+// std::inplace_vector (P0843): ни одна операция не обращается к аллокатору. Интерфейс
+// и гарантии безопасности исключений повторяют Vector, а превышение ёмкости выбрасывает
+// std::bad_alloc до изменения вектора, как исчерпание памяти у Vector.
+// TryEmplaceBack и TryPushBack вместо исключения возвращают nullptr.
+// Если T тривиально копируем, InplaceVector тоже тривиально копируем и перемещаем
+template <typename T, size_t N>
+class InplaceVector : private detail::InplaceStorage<T, N> {
+    static_assert(N > 0, "InplaceVector needs a non-empty buffer");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t kCapacity = N;
+
+    InplaceVector() = default;
+
+    explicit InplaceVector(size_t size) {
+        CheckCapacity(size);
+        detail::UninitializedValueConstructN(this->GetAddress(), size);
+        this->size_ = size;
+    }
+
+    InplaceVector(size_t size, DefaultInitT) {
+        CheckCapacity(size);
+        std::uninitialized_default_construct_n(this->GetAddress(), size);
+        this->size_ = size;
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    InplaceVector(InputIt first, InputIt last) {
+        Assign(first, last);
+    }
+
+    void Resize(size_t new_size) {
+        CheckCapacity(new_size);
+        if (new_size > this->size_) {
+            detail::UninitializedValueConstructN(end(), new_size - this->size_);
+        } else {
+            std::destroy_n(begin() + new_size, this->size_ - new_size);
+        }
+        this->size_ = new_size;
+    }
+
+    // Ёмкость фиксирована, поэтому Reserve только проверяет, что new_capacity помещается в буфер
+    void Reserve(size_t new_capacity) {
+        CheckCapacity(new_capacity);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        CheckCapacity(this->size_ + 1);
+        return *UncheckedEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Возвращает nullptr, если буфер заполнен. Исключения конструктора T пробрасываются
+    template <typename... Args>
+    T* TryEmplaceBack(Args&&... args) {
+        if (this->size_ == N) {
+            return nullptr;
+        }
+        return UncheckedEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    T* TryPushBack(const T& value) {
+        return TryEmplaceBack(value);
+    }
+
+    T* TryPushBack(T&& value) {
+        return TryEmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        if (this->size_ > 0) {
+            std::destroy_at(end() - 1);
+            --this->size_;
+        }
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(begin(), this->size_);
+        this->size_ = 0;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        CheckCapacity(this->size_ + 1);
+
+        iterator position = begin() + (pos - begin());
+        if (position == end()) {
+            return UncheckedEmplaceBack(std::forward<Args>(args)...);
+        }
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            // Элемент строится во временном хранилище, затем хвост сдвигается одним memmove
+            alignas(T) unsigned char temp[sizeof(T)];
+            T* value = new (temp) T(std::forward<Args>(args)...);
+            std::memmove(static_cast<void*>(position + 1), position
+                         , static_cast<size_t>(end() - position) * sizeof(T));
+            detail::Relocate(value, 1, position);
+        } else {
+            // Аргументы могут ссылаться на сдвигаемые элементы
+            T temp(std::forward<Args>(args)...);
+            detail::ConstructAt(end(), std::move(*(end() - 1)));
+            ++this->size_;
+            std::move_backward(position, end() - 2, end() - 1);
+            *position = std::move(temp);
+            return position;
+        }
+        ++this->size_;
+        return position;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= begin() && first <= last && last <= end());
+
+        iterator position = begin() + (first - begin());
+        const size_t count = last - first;
+        if (count == 0) {
+            return position;
+        }
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            std::destroy_n(position, count);
+            std::memmove(static_cast<void*>(position), position + count
+                         , static_cast<size_t>(end() - position - count) * sizeof(T));
+        } else {
+            detail::MoveAssignOrCopy(position + count, end(), position);
+            std::destroy_n(end() - count, count);
+        }
+        this->size_ -= count;
+        return position;
+    }
+
+    // Заменяет содержимое элементами [first, last). Итераторы не должны указывать
+    // на элементы самого вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            CheckCapacity(count);
+            this->AssignN(first, count);
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    // Обменивает элементы поштучно: общая часть обменивается, остаток длинного вектора
+    // перемещается в короткий
+    void Swap(InplaceVector& other) noexcept(
+        std::is_nothrow_swappable_v<T> && std::is_nothrow_move_constructible_v<T>) {
+        if (this == &other) {
+            return;
+        }
+        InplaceVector& shorter = this->size_ <= other.size_ ? *this : other;
+        InplaceVector& longer = this->size_ <= other.size_ ? other : *this;
+        const size_t common = shorter.size_;
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        detail::UninitializedMoveN(longer.begin() + common, longer.size_ - common, shorter.end());
+        std::destroy_n(longer.begin() + common, longer.size_ - common);
+        std::swap(this->size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return this->size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<InplaceVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < this->size_);
+        return this->GetAddress()[index];
+    }
+
+    iterator begin() noexcept {
+        return this->GetAddress();
+    }
+    iterator end() noexcept {
+        return this->GetAddress() + this->size_;
+    }
+    const_iterator begin() const noexcept {
+        return this->GetAddress();
+    }
+    const_iterator end() const noexcept {
+        return this->GetAddress() + this->size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return this->begin();
+    }
+    const_iterator cend() const noexcept {
+        return this->end();
+    }
+
+private:
+    static void CheckCapacity(size_t size) {
+        if (size > N) {
+            throw std::bad_alloc();
+        }
+    }
+
+    template <typename... Args>
+    T* UncheckedEmplaceBack(Args&&... args) {
+        assert(this->size_ < N);
+        T* value = detail::ConstructAt(end(), std::forward<Args>(args)...);
+        ++this->size_;
+        return value;
+    }
+};
@@ -1,11 +1,43 @@
 #include "vector.h"
+#include "allocators.h"
+#include "small_vector.h"
+#include "thread_executor.h"
+#include "concurrent_vector.h"
+#include "stable_vector.h"
+#include "mapped_vector.h"
+#include "vector_io.h"
+#include "shared_vector.h"
+#include "soa_vector.h"
+#include "vector_simd.h"
+#include "inplace_vector.h"
+#include "flat_map.h"
+#include "counting.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 namespace {
 
 // "Магическое" число, используемое для отслеживания живости объекта
@@ -117,6 +149,8 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+using counting::num_allocations;
+
 }  // namespace
 
 void Test1() {
@@ -433,7 +467,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -448,7 +482,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -495,7 +529,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -511,7 +545,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -530,7 +564,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -546,7 +580,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -559,97 +593,2669 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    const size_t SIZE = 1000;
+    {
+        BumpArena arena;
+        ArenaVector<int> v{ArenaAllocator<int>(&arena)};
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        assert(arena.BytesUsed() >= SIZE * sizeof(int));
+        assert(v.GetAllocator().GetResource() == &arena);
+
+        // Копия использует ту же арену
+        ArenaVector<int> copy(v);
+        assert(copy.GetAllocator() == v.GetAllocator());
+        assert(copy[SIZE / 2] == v[SIZE / 2]);
+    }
+    {
+        Obj::ResetCounters();
+        PoolResource pool;
+        {
+            PoolVector<Obj> v(SIZE, PoolAllocator<Obj>(&pool));
+            v.EmplaceBack(1);
+            assert(v.Size() == SIZE + 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        // Освобождённый блок переиспользуется выделением того же размера
+        void* p = pool.Allocate(24);
+        pool.Deallocate(p, 24);
+        assert(pool.Allocate(32) == p);
+    }
+    {
+        Obj::ResetCounters();
+        BumpArena first;
+        BumpArena second;
+        ArenaVector<Obj> v(SIZE, ArenaAllocator<Obj>(&first));
+        Obj* data = &v[0];
+
+        // Память другой арены забрать нельзя: элементы перемещаются поштучно
+        ArenaVector<Obj> other(std::move(v), ArenaAllocator<Obj>(&second));
+        assert(&other[0] != data);
+        assert(Obj::num_moved == static_cast<int>(SIZE));
+        assert(other.GetAllocator().GetResource() == &second);
+
+        ArenaVector<Obj> same(std::move(other), ArenaAllocator<Obj>(&second));
+        assert(same.Size() == SIZE);
+        assert(Obj::num_moved == static_cast<int>(SIZE));
+
+        ArenaVector<Obj> target{ArenaAllocator<Obj>(&first)};
+        target = std::move(same);
+        assert(target.Size() == SIZE);
+        assert(target.GetAllocator().GetResource() == &first);
+        assert(Obj::num_moved == static_cast<int>(SIZE * 2));
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        std::array<std::byte, 4096> storage;
+        std::pmr::monotonic_buffer_resource resource(storage.data(), storage.size());
+        pmr::Vector<int> v{std::pmr::polymorphic_allocator<int>(&resource)};
+        v.Reserve(100);
+        assert(static_cast<void*>(v.Data()) >= static_cast<void*>(storage.data()));
+        assert(static_cast<void*>(v.Data() + v.Size()) < static_cast<void*>(storage.data() + storage.size()));
+
+        // Копия pmr-вектора получает ресурс по умолчанию
+        v.PushBack(1);
+        pmr::Vector<int> copy(v);
+        assert(copy.GetAllocator().resource() == std::pmr::get_default_resource());
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+// Тип с собственными счётчиками, который разрешает вектору переносить себя через memcpy
+struct Relocatable {
+    explicit Relocatable(int value)
+        : value(std::make_unique<int>(value)) {
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
-        }
-        return *this;
+    Relocatable(Relocatable&& other) noexcept
+        : value(std::move(other.value)) {
+        ++num_moved;
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
+    Relocatable& operator=(Relocatable&& other) noexcept {
+        value = std::move(other.value);
+        ++num_move_assigned;
         return *this;
     }
-    ~C() {
-        ++dtor;
+    ~Relocatable() {
+        ++num_destroyed;
     }
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+    static void ResetCounters() {
+        num_moved = 0;
+        num_move_assigned = 0;
+        num_destroyed = 0;
     }
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+    std::unique_ptr<int> value;
+
+    static inline int num_moved = 0;
+    static inline int num_move_assigned = 0;
+    static inline int num_destroyed = 0;
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+template <>
+struct IsTriviallyRelocatable<Relocatable> : std::true_type {};
+
+void Test8() {
+    const size_t SIZE = 10;
+    {
+        Relocatable::ResetCounters();
+        Vector<Relocatable> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        assert(Relocatable::num_moved == 0);
+        assert(Relocatable::num_destroyed == 0);
+
+        v.Emplace(v.cbegin() + 3, 100);
+        assert(v.Size() == SIZE + 1);
+        assert(*v[3].value == 100);
+        assert(*v[4].value == 3);
+        assert(*v[SIZE].value == static_cast<int>(SIZE - 1));
+
+        v.Erase(v.cbegin() + 3);
+        assert(v.Size() == SIZE);
+        assert(*v[3].value == 3);
+        assert(Relocatable::num_moved == 0);
+        assert(Relocatable::num_move_assigned == 0);
+        assert(Relocatable::num_destroyed == 1);
+
+        // Вставка с реаллокацией
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(0);
+        }
+        v.Emplace(v.cbegin() + 1, 7);
+        assert(*v[1].value == 7);
+        assert(*v[2].value == 1);
+        assert(Relocatable::num_moved == 0);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Insert(v.cbegin(), std::make_unique<int>(-1));
+        v.Erase(v.cbegin() + 5);
+        assert(v.Size() == SIZE);
+        assert(*v[0] == -1);
+        assert(*v[4] == 3);
+        assert(*v[5] == 5);
+    }
+    {
+        Vector<int> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+        v.Insert(v.cbegin() + 2, 42);
+        v.Erase(v.cbegin());
+        assert(v[1] == 42);
+        assert(v[2] == 2);
+        assert(v.Size() == SIZE);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+void Test9() {
+    const size_t SIZE = 100'000;
+    {
+        MallocVector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.PushBack(v[0]);
+        assert(v.Size() == SIZE + 1);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
         }
-        Dump();
-    } catch (...) {
+        assert(v[SIZE] == 0);
+        v.Emplace(v.cbegin() + 1, v[SIZE - 1]);
+        assert(v[1] == static_cast<int>(SIZE - 1));
+        assert(v[2] == 1);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+    {
+        Vector<std::unique_ptr<int>, MallocAllocator<std::unique_ptr<int>>> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(std::make_unique<int>(i));
         }
-        Dump();
-    } catch (...) {
+        v.Reserve(SIZE);
+        assert(v.Capacity() >= SIZE);
+        assert(*v[999] == 999);
+    }
+    {
+        // Ёмкость не выходит за память, полученную от malloc: запас блока не занимается
+        // без realloc, поэтому рост на один элемент перевыделяет буфер
+        static_assert(!detail::kHasTryExpand<MallocAllocator<int>>);
+        Vector<int, MallocAllocator<int>> v;
+        v.Resize(13);
+        v.Reserve(13);
+        v.Reserve(14);
+        assert(v.Capacity() >= 14 && v.Size() == 13);
+#if defined(__GLIBC__)
+        assert(malloc_usable_size(v.Data()) >= v.Capacity() * sizeof(int));
+#endif
+        v.PushBack(13);
+        assert(v[13] == 13);
+    }
+    {
+        // Последний блок арены растёт на месте
+        BumpArena arena(1 << 16);
+        ArenaVector<Obj> v{ArenaAllocator<Obj>(&arena)};
+        v.Reserve(10);
+        v.Resize(10);
+        const Obj* data = v.Data();
+        Obj::ResetCounters();
+        v.Reserve(100);
+        assert(v.Data() == data);
+        assert(v.Capacity() == 100);
+        assert(Obj::num_moved == 0);
+        v.EmplaceBack(1);
+        assert(v.Data() == data);
     }
 }
 
-int main() {
-    try {
-        Test1();
-        Test2();
-        Test3();
-        Test4();
-        Test5();
-        Test6();
-        Benchmark();
-    } catch (const std::exception& e) {
-        std::cerr << e.what() << std::endl;
+template <typename Growth>
+std::vector<size_t> CapacitySequence(size_t count) {
+    Vector<int, std::allocator<int>, Growth> v;
+    std::vector<size_t> capacities;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t capacity = v.Capacity();
+        v.PushBack(0);
+        if (v.Capacity() != capacity) {
+            capacities.push_back(v.Capacity());
+        }
+    }
+    return capacities;
+}
+
+void Test10() {
+    assert((CapacitySequence<DoublingGrowth>(9) == std::vector<size_t>{1, 2, 4, 8, 16}));
+    assert((CapacitySequence<GoldenGrowth>(10) == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13}));
+    assert((CapacitySequence<MinInitialCapacity<8>>(17) == std::vector<size_t>{8, 16, 32}));
+    assert((CapacitySequence<CappedGrowth<64, 32, DoublingGrowth>>(40)
+            == std::vector<size_t>{1, 2, 4, 8, 16, 24, 32, 40}));
+    // 3 * 4 байта округляются до 16, 6 * 4 — до 32
+    assert((CapacitySequence<SizeClassGrowth<GoldenGrowth>>(9) == std::vector<size_t>{1, 2, 4, 8, 16}));
+    assert(SizeClassGrowth<DoublingGrowth>::NextCapacity(1000, 1001, 10) == 2048);
+    {
+        // Вставка и Emplace используют ту же политику
+        Vector<int, std::allocator<int>, MinInitialCapacity<4, GoldenGrowth>> v;
+        v.Insert(v.cbegin(), 1);
+        assert(v.Capacity() == 4);
+        v.Resize(4);
+        v.Emplace(v.cbegin() + 1, 2);
+        assert(v.Capacity() == 6);
+        assert(v[1] == 2);
+    }
+    {
+        // Ёмкость совпадает с блоком, который выделил malloc
+        MallocVector<char> v;
+        v.Reserve(1);
+        assert(v.Capacity() >= 1);
+        const size_t capacity = v.Capacity();
+        v.Resize(capacity);
+        assert(v.Capacity() == capacity);
+    }
+}
+
+template <typename V, typename = void>
+struct HasReleaseBuffer : std::false_type {};
+
+template <typename V>
+struct HasReleaseBuffer<V, std::void_t<decltype(std::declval<V&>().ReleaseBuffer())>> : std::true_type {};
+
+template <typename V, typename = void>
+struct HasAdoptBuffer : std::false_type {};
+
+template <typename V>
+struct HasAdoptBuffer<V, std::void_t<decltype(std::declval<V&>().AdoptBuffer(
+                             std::declval<VectorBuffer<typename V::value_type>>()))>> : std::true_type {};
+
+void Test11() {
+    const size_t N = 8;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v;
+        assert(v.Capacity() == N);
+        assert(v.Size() == 0);
+        assert(v.IsInline());
+        for (size_t i = 0; i < N; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(Obj::num_moved == 0);
+
+        v.EmplaceBack(static_cast<int>(N));
+        assert(!v.IsInline());
+        assert(v.Capacity() == N * 2);
+        assert(Obj::num_moved == static_cast<int>(N));
+        assert(v[N].id == static_cast<int>(N));
+
+        auto pos = v.Emplace(v.cbegin() + 1, 42, "Ivan"s);
+        assert(&*pos == &v[1]);
+        assert(v[1].name == "Ivan"s);
+        v.Erase(v.cbegin() + 1);
+        assert(v[1].id == 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N + 1));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v(N / 2);
+        v[1].id = 1;
+        SmallVector<Obj, N> copy(v);
+        assert(copy.IsInline());
+        assert(copy.Data() != v.Data());
+        assert(copy[1].id == 1);
+
+        SmallVector<Obj, N> moved(std::move(copy));
+        assert(moved.IsInline());
+        assert(moved[1].id == 1);
+
+        SmallVector<Obj, N> large(N * 2);
+        large[N].id = 2;
+        moved.Swap(large);
+        assert(moved.Size() == N * 2);
+        assert(moved[N].id == 2);
+        assert(large.Size() == N / 2);
+        assert(large[1].id == 1);
+
+        large = moved;
+        assert(large.Size() == N * 2);
+        assert(large[N].id == 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Гарантии безопасности исключений те же, что и у Vector
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = N / 2;
+        try {
+            SmallVector<Obj, N> v(N);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        SmallVector<Obj, N> v(N);
+        v[N - 1].throw_on_copy = true;
+        try {
+            SmallVector<Obj, N> copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        static_assert(std::is_nothrow_move_constructible_v<SmallVector<std::string, 4>>);
+        static_assert(std::is_nothrow_move_assignable_v<SmallVector<std::string, 4>>);
+        // Указатель на встроенный буфер не выходит за пределы объекта
+        static_assert(HasReleaseBuffer<Vector<int>>::value && HasAdoptBuffer<Vector<int>>::value);
+        static_assert(!HasReleaseBuffer<SmallVector<int, 4>>::value);
+        static_assert(!HasAdoptBuffer<SmallVector<int, 4>>::value);
+
+        SmallVector<int, 4> v(1000);
+        v[999] = 999;
+        const int* data = v.Data();
+        const size_t allocations = num_allocations;
+        SmallVector<int, 4> moved(std::move(v));
+        assert(num_allocations == allocations);
+        assert(moved.Data() == data && moved[999] == 999);
+        assert(v.Size() == 0 && v.IsInline());
+        v.PushBack(1);
+        assert(v.IsInline() && v[0] == 1);
+
+        // Элементы встроенного буфера перемещаются поштучно в текущий буфер приёмника
+        SmallVector<int, 4> small;
+        for (int i = 0; i < 3; ++i) {
+            small.PushBack(i);
+        }
+        moved = std::move(small);
+        assert(moved.Data() == data && moved.Size() == 3 && moved[2] == 2);
+        assert(small.IsInline());
+
+        // ShrinkToFit возвращает помещающиеся элементы во встроенный буфер
+        moved.ShrinkToFit();
+        assert(moved.IsInline() && moved.Capacity() == 4);
+        assert(moved.Size() == 3 && moved[0] == 0 && moved[2] == 2);
+        SmallVector<int, 4> empty(100);
+        empty.Clear();
+        empty.ShrinkToFit();
+        assert(empty.IsInline() && empty.Capacity() == 4 && empty.Size() == 0);
+        empty.PushBack(7);
+        assert(empty.IsInline() && empty[0] == 7);
+    }
+    {
+        SmallVector<TestObj, 2> v(2);
+        v.PushBack(v[0]);
+        v.Insert(v.cbegin() + 1, v[2]);
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v;
+        const std::vector<int> source{1, 2, 3, 4, 5};
+        v.Append(source.begin(), source.end());
+        assert(v.Size() == source.size());
+        assert(v.Capacity() == source.size());
+
+        std::istringstream input("6 7 8");
+        v.Append(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == 8);
+        assert(v[7] == 8);
+
+        std::istringstream middle("-1 -2");
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(middle), std::istream_iterator<int>());
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, -1, -2, 2, 3, 4, 5, 6, 7, 8}));
+
+        v.Insert(v.cbegin(), 2, v[9]);
+        assert(v[0] == 8 && v[1] == 8 && v[2] == 1);
+
+        const Vector<int> copy(v.begin() + 2, v.begin() + 5);
+        assert((std::vector<int>(copy.begin(), copy.end()) == std::vector<int>{1, -1, -2}));
+    }
+    {
+        // Вставка с реаллокацией: один буфер, элементы переносятся один раз
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        Vector<Obj> source(SIZE / 2);
+        source[0].id = 1;
+        Obj::ResetCounters();
+        auto pos = v.Insert(v.cbegin() + 2, source.begin(), source.end());
+        assert(&*pos == &v[2]);
+        assert(v.Size() == SIZE + SIZE / 2);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[2].id == 1);
+        assert(Obj::num_copied == static_cast<int>(SIZE / 2));
+        assert(Obj::num_moved == static_cast<int>(SIZE));
+        assert(Obj::num_move_assigned == 0);
+    }
+    {
+        // Вставка в запас ёмкости: хвост сдвигается один раз
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v[SIZE - 1].id = 9;
+        Vector<Obj> source(3);
+        Obj::ResetCounters();
+        v.Insert(v.cbegin() + 2, source.begin(), source.end());
+        assert(v.Size() == SIZE + 3);
+        assert(v[SIZE + 2].id == 9);
+        assert(Obj::num_moved == 3);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 2 - 3));
+        assert(Obj::num_assigned == 3);
+
+        Obj::ResetCounters();
+        v.Insert(v.cend() - 1, 4, Obj{5});
+        assert(v.Size() == SIZE + 7);
+        assert(v[SIZE + 2].id == 5 && v[SIZE + 6].id == 9);
+        assert(Obj::num_moved == 1);
+        assert(Obj::num_copied == 3);
+        assert(Obj::num_assigned == 1);
+    }
+    {
+        // При исключении во время копирования диапазона вектор не меняется
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        Vector<Obj> source(SIZE);
+        source[SIZE / 2].throw_on_copy = true;
+        const Obj* data = v.Data();
+        try {
+            v.Insert(v.cbegin() + 1, source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Data() == data);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2));
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        Vector<Obj> source(SIZE / 2);
+        Obj::ResetCounters();
+        v.Assign(source.begin(), source.end());
+        assert(v.Size() == SIZE / 2);
+        assert(v.Capacity() == SIZE);
+        assert(Obj::num_assigned == static_cast<int>(SIZE / 2));
+        assert(Obj::num_destroyed == static_cast<int>(SIZE / 2));
+
+        Vector<Obj> large(SIZE * 3);
+        v.Assign(large.begin(), large.end());
+        assert(v.Size() == SIZE * 3);
+        assert(v.Capacity() == SIZE * 3);
+    }
+}
+
+void Test13() {
+    using namespace std::literals;
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        const size_t allocations_before = num_allocations;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.Emplace(v.cbegin() + 1, i, "name"s);
+        }
+        assert(num_allocations == allocations_before);
+        assert(v.Size() == SIZE * 2);
+        assert(v[1].id == static_cast<int>(SIZE - 1));
+        assert(v[SIZE].id == 0);
+        // Временный объект разрушается, а новые элементы не теряются
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE + 1);
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.Emplace(v.cbegin() + 1);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(Obj::num_moved == 0);
+        assert(Obj::num_move_assigned == 0);
+    }
+    {
+        const size_t NUM = 10'000;
+        Vector<std::string> v(NUM);
+        v.Reserve(NUM * 2);
+        const std::string value = "value";
+        const size_t allocations_before = num_allocations;
+        for (size_t i = 0; i < NUM; ++i) {
+            v.Insert(v.cbegin() + v.Size() / 2, value.substr(0, 4));
+        }
+        assert(num_allocations == allocations_before);
+    }
+    {
+        // Erase сдвигает хвост присваиванием в живые объекты
+        Vector<std::string> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack("a string long enough to allocate "s + std::to_string(i));
+        }
+        v.Erase(v.cbegin() + 1);
+        v.Erase(v.cbegin());
+        assert(v.Size() == SIZE - 2);
+        assert(v[0] == "a string long enough to allocate 2"s);
+        assert(v[SIZE - 3] == "a string long enough to allocate 9"s);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, kDefaultInit);
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE * 2));
+        v.ResizeDefaultInit(SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        Obj::default_construction_throw_countdown = SIZE / 2;
+        try {
+            v.ResizeDefaultInit(SIZE * 2);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    {
+        Vector<char> v(SIZE, kDefaultInit);
+        std::fill(v.begin(), v.end(), 'x');
+        v.ResizeUninitialized(SIZE / 2);
+        v.ResizeUninitialized(SIZE);
+        // Память не перезаписывалась
+        assert(v[SIZE - 1] == 'x');
+        v.ResizeUninitialized(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE - 1] == 'x');
+    }
+    {
+        Vector<float> v;
+        v.ResizeDefaultInit(SIZE);
+        v.Resize(SIZE * 2);
+        assert(v[SIZE * 2 - 1] == 0.0f);
+    }
+}
+
+// Перемещение не помечено noexcept, поэтому вектор копирует элементы при реаллокации
+struct NoexceptlessMove {
+    NoexceptlessMove() = default;
+    NoexceptlessMove(const NoexceptlessMove&) = default;
+    NoexceptlessMove(NoexceptlessMove&&) {
     }
-}
\ No newline at end of file
+    NoexceptlessMove& operator=(const NoexceptlessMove&) = default;
+    NoexceptlessMove& operator=(NoexceptlessMove&&) = default;
+};
+
+struct Test15Tag {};
+
+void Test15() {
+    const size_t SIZE = 100;
+#ifndef VECTOR_HAS_CHECK_SCOPE
+    static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+#endif
+    {
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth, InstanceStats> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack();
+        }
+        // Ёмкости 1, 2, 4, ..., 128
+        StatsCounters stats = v.GetStats().Snapshot();
+        assert(stats.allocations == 8);
+        assert(stats.peak_capacity == 128);
+        assert(stats.relocated == 127);
+        assert(stats.copy_fallbacks == 0);
+
+        auto moved = std::move(v);
+        assert(moved.GetStats().Snapshot().allocations == 8);
+        assert(v.GetStats().Snapshot().allocations == 0);
+
+        // Обмен и перемещающее присваивание передают счётчики вместе с буфером
+        v.EmplaceBack();
+        moved.Swap(v);
+        assert(moved.Size() == 1 && moved.GetStats().Snapshot().allocations == 1);
+        assert(v.Size() == SIZE && v.GetStats().Snapshot().allocations == 8);
+        moved = std::move(v);
+        assert(moved.Size() == SIZE && moved.GetStats().Snapshot().allocations == 8);
+        assert(moved.GetStats().Snapshot().peak_capacity == 128);
+        assert(v.GetStats().Snapshot().allocations == 1);
+
+        auto copy = moved;
+        assert(copy.GetStats().Snapshot().allocations == 1);
+        assert(copy.GetStats().Snapshot().relocated == 0);
+
+        // Копия не помещается в буфер, и вектор забирает буфер временного вектора
+        copy.Resize(SIZE * 2);
+        moved = copy;
+        stats = moved.GetStats().Snapshot();
+        assert(stats.allocations == 9);
+        assert(stats.peak_capacity == SIZE * 2);
+    }
+    {
+        using TaggedVector = Vector<NoexceptlessMove, std::allocator<NoexceptlessMove>, DoublingGrowth
+                                    , TaggedStats<Test15Tag>>;
+        TaggedStats<Test15Tag>::Reset();
+        TaggedVector a(SIZE);
+        TaggedVector b;
+        a.Reserve(SIZE * 2);
+        b.PushBack(NoexceptlessMove());
+        b.PushBack(NoexceptlessMove());
+        const StatsCounters stats = TaggedStats<Test15Tag>::Get();
+        assert(stats.allocations == 4);
+        assert(stats.peak_capacity == SIZE * 2);
+        assert(stats.relocated == SIZE + 1);
+        assert(stats.copy_fallbacks == SIZE + 1);
+
+        std::ostringstream out;
+        out << stats;
+        assert(out.str() == "{\"allocations\":4,\"peak_capacity\":200,\"relocated\":101,\"copy_fallbacks\":101}");
+    }
+}
+
+void Test16() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v.Resize(SIZE / 2);
+        assert(v.Capacity() == SIZE * 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 2));
+
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        v.Resize(SIZE / 4);
+        v.ReleaseMemory();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == 0);
+        assert(v.Data() == nullptr);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    {
+        Vector<int, std::allocator<int>, Hysteresis<>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 128);
+        // Ёмкость сохраняется, пока размер не меньше четверти ёмкости
+        while (v.Size() > 32) {
+            v.PopBack();
+        }
+        assert(v.Capacity() == 128);
+        v.PopBack();
+        assert(v.Capacity() == 62);
+        assert(v.Size() == 31);
+        assert(v[30] == 30);
+        auto it = v.Erase(v.begin() + 1);
+        assert(*it == 2);
+        v.Resize(5);
+        assert(v.Capacity() == 10);
+        v.Clear();
+        assert(v.Capacity() == 10);
+        v.Resize(0);
+        // Между порогами роста и сжатия операции не перевыделяют память
+        v.Resize(10);
+        const size_t allocations_before = num_allocations;
+        for (int i = 0; i < 10; ++i) {
+            v.PopBack();
+            v.PushBack(i);
+        }
+        assert(num_allocations == allocations_before);
+    }
+    {
+        SmallVector<int, 8, std::allocator<int>, Hysteresis<>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(!v.IsInline());
+        v.Resize(4);
+        assert(v.IsInline());
+        assert(v.Capacity() == 8);
+        v.Resize(1);
+        assert(v.IsInline());
+        assert(v[0] == 0);
+
+        SmallVector<int, 8> w(SIZE);
+        w.Resize(4);
+        w.ShrinkToFit();
+        assert(w.IsInline());
+        w.ShrinkToFit();
+        assert(w.IsInline());
+        assert(w.Capacity() == 8);
+    }
+}
+
+void Test17() {
+    const size_t PAGE = size_t{2} << 20;
+    {
+        LargePageOptions options;
+        options.threshold_bytes = 64 * 1024;
+        LargePageVector<int> v{LargePageAllocator<int>(options)};
+        v.Reserve(1000);
+        assert(v.Capacity() == 1000);
+
+        // Буфер отображения выровнен по большой странице
+        const size_t allocations_before = num_allocations;
+        v.Reserve(PAGE / sizeof(int) - 1);
+        assert(num_allocations == allocations_before);
+        assert(v.Capacity() == PAGE / sizeof(int) - 1);
+        assert(reinterpret_cast<std::uintptr_t>(v.Data()) % PAGE == 0);
+
+        for (int i = 0; i < static_cast<int>(PAGE / sizeof(int) * 3); ++i) {
+            v.PushBack(i);
+        }
+        assert(num_allocations == allocations_before);
+        for (size_t i = 0; i < v.Size(); i += 1000) {
+            assert(v[i] == static_cast<int>(i));
+        }
+
+        v.Resize(100);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 100);
+        assert(v[99] == 99);
+
+        // Новое отображение отдаётся вектору целиком
+        LargePageVector<int> w{LargePageAllocator<int>(options)};
+        w.Reserve(PAGE / sizeof(int) - 1);
+        assert(w.Capacity() == PAGE / sizeof(int));
+    }
+    {
+        // Явные большие страницы и привязка к узлу 0 работают и там, где их нет:
+        // отображение откатывается к обычным страницам, а mbind — лишь подсказка
+        LargePageOptions options;
+        options.threshold_bytes = 4096;
+        options.pages = LargePageKind::kHuge2M;
+        options.numa = NumaPolicy::kBind;
+        options.node_mask = 1;
+        LargePageVector<std::string> v{LargePageAllocator<std::string>(options)};
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        assert(v[999] == "999");
+
+        LargePageVector<std::string> copy(v);
+        assert(copy.GetAllocator() == v.GetAllocator());
+        LargePageVector<std::string> other;
+        assert(other.GetAllocator() != v.GetAllocator());
+        other = std::move(copy);
+        assert(other.GetAllocator() == v.GetAllocator());
+        assert(other[500] == "500");
+    }
+}
+
+struct alignas(128) OverAligned {
+    int value = 0;
+};
+
+void Test18() {
+    static_assert(Vector<int>::kAlignment == alignof(int));
+    static_assert(Vector<OverAligned>::kAlignment == 128);
+    static_assert(AlignedVector<float>::kAlignment == 64);
+    static_assert(AlignedVector<double, 32>::kAlignment == 32);
+    {
+        AlignedVector<float> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<std::uintptr_t>(v.Data()) % 64 == 0);
+            // Буфер состоит из целых блоков по 64 байта
+            assert(v.Capacity() * sizeof(float) % 64 == 0);
+        }
+        assert(v[999] == 999.0f);
+        AlignedVector<float> copy(v);
+        assert(reinterpret_cast<std::uintptr_t>(copy.Data()) % 64 == 0);
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 16);
+    }
+    {
+        // 64 байта не делятся на 12: ёмкость — число целых элементов в выделенных блоках
+        struct Rgb {
+            float r, g, b;
+        };
+        static_assert(sizeof(Rgb) == 12);
+        for (size_t n = 1; n <= 40; ++n) {
+            AlignedVector<Rgb> v;
+            v.Reserve(n);
+            assert(reinterpret_cast<std::uintptr_t>(v.Data()) % 64 == 0);
+            assert(v.Capacity() == (n * sizeof(Rgb) + 63) / 64 * 64 / sizeof(Rgb));
+            const Rgb* data = v.Data();
+            while (v.Size() < v.Capacity()) {
+                v.PushBack(Rgb{1.0f, 2.0f, static_cast<float>(v.Size())});
+            }
+            assert(v.Data() == data);
+            assert(v[v.Size() - 1].b == static_cast<float>(v.Size() - 1));
+        }
+    }
+    {
+        Vector<OverAligned> v(3);
+        v.Reserve(100);
+        assert(reinterpret_cast<std::uintptr_t>(v.Data()) % 128 == 0);
+        SmallVector<OverAligned, 2> small(1);
+        assert(reinterpret_cast<std::uintptr_t>(small.Data()) % 128 == 0);
+    }
+}
+
+// Счётчики атомарны: элементы создаются и разрушаются из нескольких потоков.
+// Перемещение не помечено noexcept, поэтому Reserve копирует элементы
+struct ParallelObj {
+    ParallelObj() {
+        MaybeThrow();
+        ++alive;
+    }
+    ParallelObj(const ParallelObj& other)
+        : id(other.id) {
+        MaybeThrow();
+        ++alive;
+    }
+    ParallelObj(ParallelObj&& other)
+        : id(other.id) {
+        ++alive;
+    }
+    ParallelObj& operator=(const ParallelObj& other) = default;
+    ~ParallelObj() {
+        --alive;
+    }
+
+    static void MaybeThrow() {
+        if (throw_countdown.load() > 0 && throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+    }
+
+    int id = 0;
+    static inline std::atomic<int> alive = 0;
+    static inline std::atomic<int> throw_countdown = 0;
+};
+
+void Test19() {
+    const size_t SIZE = 1'000'000;
+    const ThreadExecutor exec(4);
+    {
+        Vector<ParallelObj> v(SIZE, exec);
+        assert(v.Size() == SIZE);
+        assert(ParallelObj::alive == static_cast<int>(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+
+        Vector<ParallelObj> copy(v, exec);
+        assert(copy.Size() == SIZE);
+        assert(copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        // Исключение в середине копирования разрушает элементы всех частей
+        ParallelObj::throw_countdown = SIZE / 2;
+        try {
+            Vector<ParallelObj> failed(v, exec);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        ParallelObj::throw_countdown = 0;
+        assert(ParallelObj::alive == static_cast<int>(SIZE * 2));
+
+        ParallelObj::throw_countdown = SIZE / 2;
+        const ParallelObj* data = v.Data();
+        try {
+            v.Reserve(SIZE * 2, exec);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        ParallelObj::throw_countdown = 0;
+        assert(v.Data() == data);
+        assert(v.Capacity() == SIZE);
+        assert(ParallelObj::alive == static_cast<int>(SIZE * 2));
+
+        v.Reserve(SIZE * 2, exec);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE / 3].id == static_cast<int>(SIZE / 3));
+        assert(ParallelObj::alive == static_cast<int>(SIZE * 2));
+
+        copy.Assign(v.begin(), v.begin() + SIZE / 2, exec);
+        assert(copy.Size() == SIZE / 2);
+        assert(ParallelObj::alive == static_cast<int>(SIZE + SIZE / 2));
+        copy.Assign(v.begin(), v.end(), exec);
+        assert(copy.Size() == SIZE);
+        assert(copy.Capacity() == SIZE);
+        v.PushBack(ParallelObj());
+        copy.Assign(v.begin(), v.end(), exec);
+        assert(copy.Size() == SIZE + 1);
+
+        v.Clear(exec);
+        copy.Clear(exec);
+        assert(ParallelObj::alive == 0);
+    }
+    {
+        // Тривиально перемещаемые элементы переносятся побайтово
+        Vector<int> v(SIZE, exec);
+        assert(v[SIZE - 1] == 0);
+        std::iota(v.begin(), v.end(), 0);
+        v.Reserve(SIZE * 3, exec);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        Vector<int> small(10, exec);
+        assert(small.Size() == 10);
+    }
+}
+
+void Test20() {
+    const int THREADS = 8;
+    const int PER_THREAD = 10'000;
+    {
+        ConcurrentVector<int> v;
+        const int& first = v.EmplaceBack(-1);
+        Vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.EmplaceBack([&v, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    v.PushBack(t * PER_THREAD + i);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        // Рост не перемещает элементы
+        assert(&first == &v[0]);
+        assert(v.Size() == THREADS * PER_THREAD + 1);
+
+        Vector<int> frozen = v.Freeze();
+        assert(v.Size() == 0);
+        assert(frozen.Size() == THREADS * PER_THREAD + 1);
+        assert(frozen.Capacity() == frozen.Size());
+        std::sort(frozen.begin(), frozen.end());
+        for (int i = 0; i <= THREADS * PER_THREAD; ++i) {
+            assert(frozen[i] == i - 1);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        ConcurrentVector<Obj> v;
+        v.Reserve(100);
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        v.EmplaceBack(10);
+        assert(v.Size() == 12);
+        assert(!v.IsConstructed(10));
+        assert(v.IsConstructed(11));
+        assert(v[11].id == 10);
+        assert(Obj::GetAliveObjectCount() == 11);
+
+        Vector<Obj> frozen = v.Freeze();
+        assert(frozen.Size() == 11);
+        assert(frozen[10].id == 10);
+        assert(Obj::num_moved == 11);
+        assert(Obj::GetAliveObjectCount() == 11);
+
+        for (int i = 0; i < 1000; ++i) {
+            v.EmplaceBack(i);
+        }
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test21() {
+    const size_t SIZE = 10'000;
+    {
+        Obj::ResetCounters();
+        StableVector<Obj, std::allocator<Obj>, 64> v;
+        const Obj& first = v.EmplaceBack(0);
+        for (int i = 1; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        // Рост не перемещает и не копирует элементы
+        assert(&first == &v[0]);
+        assert(Obj::num_moved == 0);
+        assert(Obj::num_copied == 0);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == (SIZE + 63) / 64 * 64);
+        assert(v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        auto it = std::find_if(v.begin(), v.end(), [](const Obj& obj) {
+            return obj.id == 200;
+        });
+        assert(it - v.begin() == 200);
+        assert(it->id == 200);
+        StableVector<Obj, std::allocator<Obj>, 64>::const_iterator cit = it;
+        assert(cit[1].id == 201);
+
+        StableVector<Obj, std::allocator<Obj>, 64> copy(v);
+        assert(copy.Size() == SIZE);
+        assert(copy[SIZE / 2].id == static_cast<int>(SIZE / 2));
+        copy.Resize(10);
+        copy.ShrinkToFit();
+        assert(copy.Capacity() == 64);
+        copy = v;
+        assert(copy.Size() == SIZE);
+        StableVector<Obj, std::allocator<Obj>, 64> moved(std::move(copy));
+        assert(moved.Size() == SIZE);
+        assert(copy.Size() == 0);
+        v.Swap(moved);
+        moved.PopBack();
+        assert(moved.Size() == SIZE - 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Исключение в конструкторе копии разрушает уже скопированные элементы
+        StableVector<Obj> v(100);
+        v[50].throw_on_copy = true;
+        Obj::ResetCounters();
+        try {
+            StableVector<Obj> copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::num_copied == 50);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        // Элементы не обязаны перемещаться
+        StableVector<std::atomic<int>> counters;
+        for (int i = 0; i < 1000; ++i) {
+            counters.EmplaceBack(i);
+        }
+        assert(counters[999].load() == 999);
+
+        StableVector<int, std::allocator<int>, 16> numbers;
+        for (int i = 0; i < 100; ++i) {
+            numbers.PushBack(100 - i);
+        }
+        std::sort(numbers.begin(), numbers.end());
+        assert(std::is_sorted(numbers.cbegin(), numbers.cend()));
+        assert(numbers[0] == 1);
+    }
+}
+
+struct Point {
+    int32_t x;
+    int32_t y;
+};
+
+template <typename V, typename = void>
+struct HasPushBack : std::false_type {};
+
+template <typename V>
+struct HasPushBack<V, std::void_t<decltype(std::declval<V&>().PushBack(std::declval<typename V::value_type>()))>>
+    : std::true_type {};
+
+void Test22() {
+    const std::string path = "/tmp/advanced_vector_test22_" + std::to_string(::getpid()) + ".bin";
+    {
+        Vector<Point> points;
+        points.Reserve(1000);
+        for (int32_t i = 0; i < 600; ++i) {
+            points.PushBack({i, -i});
+        }
+        SaveMapped(path, points);
+
+        // Открытие не копирует элементы: данные читаются прямо из отображения
+        const size_t allocations_before = num_allocations;
+        MappedView<Point> view = OpenMapped<Point>(path);
+        assert(num_allocations - allocations_before <= 1);
+        assert(view.Size() == 600);
+        assert(view.Capacity() == 1000);
+        assert(reinterpret_cast<std::uintptr_t>(view.Data()) % alignof(Point) == 0);
+        for (int32_t i = 0; i < 600; ++i) {
+            assert(view[i].x == i && view[i].y == -i);
+        }
+        assert(std::distance(view.begin(), view.end()) == 600);
+
+        // Изменяемая копия живёт в обычной памяти
+        Vector<Point> copy = view.ToVector();
+        copy.PushBack({1, 1});
+        assert(copy.Size() == 601 && copy[599].x == 599 && view.Size() == 600);
+    }
+    {
+        // Отображение только для чтения не даёт изменяющих операций, копирование при записи — даёт
+        static_assert(!HasPushBack<MappedView<Point>>::value);
+        static_assert(std::is_const_v<std::remove_reference_t<decltype(std::declval<MappedView<Point>&>()[0])>>);
+        static_assert(std::is_same_v<decltype(std::declval<MappedView<Point>&>().Data()), const Point*>);
+        static_assert(std::is_same_v<decltype(OpenMapped<Point>(path, MapMode::kReadOnly)), MappedView<Point>>);
+        static_assert(HasPushBack<MappedVector<Point>>::value);
+        static_assert(std::is_same_v<decltype(OpenMapped<Point>(path, MapMode::kCopyOnWrite)), MappedVector<Point>>);
+
+        // Рост сверх ёмкости файла переносит элементы в обычную память
+        MappedVector<Point> mapped = OpenMapped<Point>(path, MapMode::kCopyOnWrite);
+        mapped.Reserve(2000);
+        assert(mapped.Capacity() == 2000);
+        assert(mapped[599].x == 599);
+        mapped.PushBack({1, 1});
+        assert(mapped.Size() == 601);
+    }
+    {
+        // Запись в режиме копирования при записи не меняет файл
+        MappedVector<Point> mapped = OpenMapped<Point>(path, MapMode::kCopyOnWrite);
+        mapped[0].x = 42;
+        for (int32_t i = 0; i < 400; ++i) {
+            mapped.PushBack({i, i});
+        }
+        assert(mapped.Capacity() == 1000);
+        assert(mapped.Size() == 1000);
+
+        const MappedView<Point> reopened = OpenMapped<Point>(path);
+        assert(reopened.Size() == 600);
+        assert(reopened[0].x == 0);
+
+        // Копия получает собственную память
+        MappedVector<Point> copy(mapped);
+        assert(copy[0].x == 42);
+        assert(copy.Size() == 1000);
+        assert(!copy.GetAllocator().GetRegion());
+    }
+    {
+        // Файл нельзя открыть другим типом элементов
+        bool thrown = false;
+        try {
+            OpenMapped<int64_t>(path);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        // Отпечаток не зависит от компилятора: тот же файл открывается в сборке GCC и Clang
+        assert(TypeFingerprint<int32_t>::Get() == 0x3749596c1b70c522ull);
+        assert(TypeFingerprint<Point>::Get() == 0x3b08626c86022e27ull);
+        assert(TypeFingerprint<int32_t>::Get() != TypeFingerprint<uint32_t>::Get());
+        assert(TypeFingerprint<int32_t>::Get() != TypeFingerprint<float>::Get());
+
+        thrown = false;
+        try {
+            OpenMapped<Point>(path + ".missing");
+        } catch (const std::system_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        Vector<Point> empty;
+        SaveMapped(path, empty);
+        const MappedView<Point> mapped = OpenMapped<Point>(path);
+        assert(mapped.Size() == 0);
+        assert(mapped.Capacity() == 0);
+    }
+    ::unlink(path.c_str());
+}
+
+void Test23() {
+    Vector<int> numbers;
+    for (int i = 0; i < 1000; ++i) {
+        numbers.PushBack(i * 3);
+    }
+    {
+        std::stringstream stream;
+        WriteTo(stream, numbers);
+        assert(stream.str().size() == SerializedSize(numbers));
+        assert(SerializedSize(numbers) == sizeof(uint64_t) + 1000 * sizeof(int));
+
+        // Память выделяется один раз по длине из префикса
+        Vector<int> restored;
+        const size_t allocations_before = num_allocations;
+        ReadFrom(stream, restored);
+        assert(num_allocations - allocations_before == 1);
+        assert(restored.Size() == 1000);
+        assert(restored.Capacity() == 1000);
+        assert(std::equal(restored.begin(), restored.end(), numbers.begin()));
+
+        // Обрыв данных не меняет вектор
+        std::stringstream truncated(stream.str().substr(0, 100));
+        bool thrown = false;
+        try {
+            ReadFrom(truncated, restored);
+        } catch (const std::ios_base::failure&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(restored.Size() == 1000);
+    }
+    {
+        Vector<Vector<char>> lines;
+        lines.EmplaceBack(3).begin()[2] = 'a';
+        lines.EmplaceBack();
+        lines.EmplaceBack(5).begin()[4] = 'b';
+        std::stringstream stream;
+        WriteTo(stream, lines);
+        Vector<Vector<char>> restored;
+        ReadFrom(stream, restored);
+        assert(restored.Size() == 3);
+        assert(restored[0].Size() == 3 && restored[0][2] == 'a');
+        assert(restored[1].Size() == 0);
+        assert(restored[2].Size() == 5 && restored[2][4] == 'b');
+    }
+    {
+        int fds[2];
+        [[maybe_unused]] const int result = ::pipe(fds);
+        assert(result == 0);
+        WriteTo(fds[1], numbers);
+        Vector<Vector<int>> nested;
+        nested.PushBack(numbers);
+        nested.EmplaceBack();
+        WriteTo(fds[1], nested);
+        ::close(fds[1]);
+
+        Vector<int> restored;
+        ReadFrom(fds[0], restored);
+        assert(std::equal(restored.begin(), restored.end(), numbers.begin(), numbers.end()));
+        Vector<Vector<int>> restored_nested;
+        ReadFrom(fds[0], restored_nested);
+        assert(restored_nested.Size() == 2);
+        assert(restored_nested[0].Size() == 1000 && restored_nested[1].Size() == 0);
+
+        bool thrown = false;
+        try {
+            ReadFrom(fds[0], restored);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(restored.Size() == 1000);
+        ::close(fds[0]);
+    }
+    {
+        Vector<std::byte> buffer(SerializedSize(numbers));
+        std::byte* end = WriteTo(buffer.Data(), buffer.Data() + buffer.Size(), numbers);
+        assert(end == buffer.Data() + buffer.Size());
+
+        Vector<int> restored;
+        const std::byte* position = ReadFrom(buffer.Data(), buffer.Data() + buffer.Size(), restored);
+        assert(position == buffer.Data() + buffer.Size());
+        assert(std::equal(restored.begin(), restored.end(), numbers.begin(), numbers.end()));
+
+        bool thrown = false;
+        try {
+            WriteTo(buffer.Data(), buffer.Data() + buffer.Size() - 1, numbers);
+        } catch (const std::length_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        // Длина в префиксе больше данных: ошибка до выделения памяти под элементы,
+        // выделяется только текст исключения
+        thrown = false;
+        const size_t allocations_before = num_allocations;
+        try {
+            ReadFrom(buffer.Data(), buffer.Data() + buffer.Size() - 1, restored);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(num_allocations - allocations_before <= 1);
+        assert(restored.Size() == 1000);
+
+#ifdef VECTOR_IO_HAS_SPAN
+        const std::span<std::byte> rest = WriteTo(std::span<std::byte>(buffer.Data(), buffer.Size()), numbers);
+        assert(rest.empty());
+        const std::span<const std::byte> unread = ReadFrom(std::span<const std::byte>(buffer.Data(), buffer.Size()), restored);
+        assert(unread.empty());
+        assert(restored.Size() == 1000);
+#endif
+    }
+}
+
+void Test24() {
+    const size_t SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> source;
+        source.Reserve(SIZE);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            source.EmplaceBack(i);
+        }
+        const Obj* buffer = source.Data();
+        SharedVector<Obj> shared(std::move(source));
+        assert(shared.begin() == buffer);
+        assert(shared.Size() == SIZE);
+        assert(Obj::num_copied == 0 && Obj::num_moved == 0);
+
+        // Копии разделяют буфер и не копируют элементы
+        Vector<SharedVector<Obj>> readers;
+        readers.Reserve(100);
+        const size_t allocations_before = num_allocations;
+        for (int i = 0; i < 100; ++i) {
+            readers.PushBack(shared);
+        }
+        assert(num_allocations == allocations_before);
+        assert(Obj::num_copied == 0);
+        assert(shared.UseCount() == 101);
+        assert(readers[99].begin() == buffer);
+        assert(readers[99][SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        // Первая запись отделяет копию, последующие работают на месте
+        SharedVector<Obj>& writer = readers[0];
+        writer.Mutable()[0].id = -1;
+        assert(Obj::num_copied == static_cast<int>(SIZE));
+        assert(writer.begin() != buffer);
+        assert(!writer.IsShared());
+        assert(shared.UseCount() == 100);
+        assert(shared[0].id == 0 && readers[1][0].id == 0);
+        writer.Mutable().EmplaceBack(static_cast<int>(SIZE));
+        writer.Mutable()[1].id = -2;
+        assert(Obj::num_copied == static_cast<int>(SIZE));
+        assert(writer.Size() == SIZE + 1 && writer[1].id == -2);
+
+        // Release единственного владельца отдаёт буфер без копирования
+        readers.Clear();
+        Vector<Obj> thawed = shared.Release();
+        assert(thawed.Data() == buffer);
+        assert(shared.Size() == 0 && shared.begin() == shared.end());
+        assert(Obj::num_copied == static_cast<int>(SIZE));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+
+        // Release общего буфера копирует элементы
+        SharedVector<Obj> again(std::move(thawed));
+        SharedVector<Obj> copy = again;
+        Vector<Obj> released = again.Release();
+        assert(released.Data() != copy.begin());
+        assert(released.Size() == SIZE && copy.UseCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SharedVector<int> empty;
+        assert(empty.Size() == 0 && empty.UseCount() == 0);
+        empty.Mutable().PushBack(1);
+        assert(empty.Size() == 1 && empty[0] == 1);
+    }
+    {
+        // Читатели в других потоках отпускают копии, после чего запись идёт на месте.
+        // Под ThreadSanitizer проверяется, что чтения читателей упорядочены до записи
+        SharedVector<int> shared{Vector<int>(SIZE)};
+        const int* buffer = shared.begin();
+        std::vector<std::thread> readers;
+        std::atomic<long long> total = 0;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([copy = shared, &total]() mutable {
+                total += std::accumulate(copy.begin(), copy.end(), 0LL);
+                copy = SharedVector<int>();
+            });
+        }
+        while (shared.IsShared()) {
+            std::this_thread::yield();
+        }
+        shared.Mutable()[0] = 1;
+        assert(shared.begin() == buffer);
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(total == 0 && shared[0] == 1);
+    }
+}
+
+void Test25() {
+    const int SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+
+        // Диапазон удаляется одним сдвигом хвоста
+        auto it = v.Erase(v.cbegin() + 10, v.cbegin() + 110);
+        assert(it == v.begin() + 10 && it->id == 110);
+        assert(v.Size() == static_cast<size_t>(SIZE - 100));
+        assert(Obj::num_move_assigned == SIZE - 110);
+        assert(Obj::num_destroyed == 100);
+        assert(v.Erase(v.cbegin() + 5, v.cbegin() + 5) == v.begin() + 5);
+        assert(v.Size() == static_cast<size_t>(SIZE - 100));
+
+        // Каждый оставшийся элемент переносится не больше одного раза
+        Obj::ResetCounters();
+        const size_t erased = v.EraseIf([](const Obj& obj) {
+            return obj.id % 2 == 1;
+        });
+        assert(erased == static_cast<size_t>(SIZE - 100) / 2);
+        assert(v.Size() == static_cast<size_t>(SIZE - 100) / 2);
+        assert(Obj::num_move_assigned < static_cast<int>(v.Size()));
+        assert(Obj::num_destroyed == static_cast<int>(erased));
+        assert(std::all_of(v.begin(), v.end(), [](const Obj& obj) {
+            return obj.id % 2 == 0;
+        }));
+        assert(std::is_sorted(v.begin(), v.end(), [](const Obj& lhs, const Obj& rhs) {
+            return lhs.id < rhs.id;
+        }));
+        assert(v.EraseIf([](const Obj&) {
+            return false;
+        }) == 0);
+
+        // Перенос последнего элемента на место удалённого
+        Obj::ResetCounters();
+        const int last_id = v[v.Size() - 1].id;
+        it = v.UnorderedErase(v.cbegin() + 3);
+        assert(it->id == last_id);
+        assert(Obj::num_move_assigned == 1 && Obj::num_destroyed == 1);
+        const size_t size = v.Size();
+        it = v.UnorderedErase(v.cend() - 1);
+        assert(it == v.end() && v.Size() == size - 1);
+    }
+    {
+        Vector<int> numbers;
+        for (int i = 0; i < SIZE; ++i) {
+            numbers.PushBack(i);
+        }
+        numbers.Erase(numbers.cbegin(), numbers.cbegin() + 500);
+        assert(numbers.Size() == 500 && numbers[0] == 500);
+        numbers.EraseIf([](int x) {
+            return x % 3 != 0;
+        });
+        assert(numbers.Size() == 167 && numbers[0] == 501 && numbers[1] == 504);
+        numbers.UnorderedErase(numbers.cbegin());
+        assert(numbers[0] == 999 && numbers.Size() == 166);
+    }
+    {
+        // Исключение предиката оставляет непроверенные элементы на месте
+        Vector<std::string> strings;
+        Vector<int> numbers;
+        for (int i = 0; i < 100; ++i) {
+            strings.PushBack(std::to_string(i));
+            numbers.PushBack(i);
+        }
+        int calls = 0;
+        const auto pred = [&calls](const auto& value) {
+            if (++calls == 50) {
+                throw std::runtime_error("stop");
+            }
+            (void)value;
+            return calls % 2 == 0;
+        };
+        try {
+            strings.EraseIf(pred);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(strings.Size() == 100 - 24);
+        assert(strings[0] == "0" && strings[24] == "48" && strings[25] == "49" && strings[75] == "99");
+
+        calls = 0;
+        try {
+            numbers.EraseIf(pred);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(numbers.Size() == 100 - 24);
+        assert(numbers[0] == 0 && numbers[24] == 48 && numbers[25] == 49 && numbers[75] == 99);
+    }
+    {
+        // Сжимающая политика роста освобождает память после удаления
+        Vector<int, std::allocator<int>, Hysteresis<>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        v.EraseIf([](int x) {
+            return x >= 10;
+        });
+        assert(v.Size() == 10);
+        assert(v.Capacity() < 100);
+    }
+}
+
+// Копируется при переносе, потому что перемещение не помечено noexcept
+struct FlakyCopy {
+    FlakyCopy() = default;
+    explicit FlakyCopy(int value)
+        : value(value) {
+    }
+    FlakyCopy(const FlakyCopy& other)
+        : value(other.value) {
+        if (copies_until_throw > 0 && --copies_until_throw == 0) {
+            throw std::runtime_error("Oops");
+        }
+    }
+    FlakyCopy(FlakyCopy&& other)
+        : value(other.value) {
+    }
+    FlakyCopy& operator=(const FlakyCopy&) = default;
+
+    int value = 0;
+    static inline int copies_until_throw = 0;
+};
+
+// Только перемещается, и перемещение может выбросить исключение
+struct FlakyMove {
+    explicit FlakyMove(int value)
+        : value(value) {
+        ++alive;
+    }
+    FlakyMove(const FlakyMove&) = delete;
+    FlakyMove(FlakyMove&& other)
+        : value(other.value) {
+        if (moves_until_throw > 0 && --moves_until_throw == 0) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+    FlakyMove& operator=(FlakyMove&&) = default;
+    ~FlakyMove() {
+        --alive;
+    }
+
+    int value = 0;
+    static inline int moves_until_throw = 0;
+    static inline int alive = 0;
+};
+
+void Test26() {
+    const int SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        SoaVector<int, double, Obj> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(SIZE - i, i * 0.5, i);
+        }
+        assert(v.Size() == static_cast<size_t>(SIZE));
+        assert(Obj::num_copied == 0);
+
+        // Столбцы лежат в памяти подряд
+        const ColumnSpan<int> keys = v.Column<0>();
+        assert(keys.size() == v.Size());
+        assert(&keys[SIZE - 1] == keys.data() + (SIZE - 1));
+        assert(std::accumulate(keys.begin(), keys.end(), 0) == SIZE * (SIZE + 1) / 2);
+        const ColumnSpan<const double> halves = std::as_const(v).Column<1>();
+        assert(halves[10] == 5.0);
+
+        // Прокси-ссылки работают с алгоритмами std::
+        std::sort(v.begin(), v.end(), [](const auto& lhs, const auto& rhs) {
+            return GetField<0>(lhs) < GetField<0>(rhs);
+        });
+        assert(v[0].Get<0>() == 1 && v[0].Get<2>().id == SIZE - 1);
+        assert(v[SIZE - 1].Get<1>() == 0.0);
+        assert(Obj::GetAliveObjectCount() == SIZE);
+        assert(std::is_sorted(v.Column<0>().begin(), v.Column<0>().end()));
+
+        std::reverse(v.begin(), v.end());
+        assert(v[0].Get<0>() == SIZE);
+        auto it = std::find_if(v.cbegin(), v.cend(), [](const auto& row) {
+            return GetField<0>(row) == 10;
+        });
+        assert(it.Index() == static_cast<size_t>(SIZE - 10));
+
+        SoaVector<int, double> pairs;
+        for (int i = 0; i < SIZE; ++i) {
+            pairs.EmplaceBack(i % 10, -i);
+        }
+        std::sort(pairs.begin(), pairs.end());
+        assert(std::is_sorted(pairs.cbegin(), pairs.cend()));
+        assert(pairs[0] == std::make_tuple(0, -990.0));
+
+        // Приведение прокси к value_type копирует строку
+        std::tuple<int, double, Obj> row = v[5];
+        assert(std::get<0>(row) == SIZE - 5 && std::get<2>(row).id == 5);
+        assert(v[5].Get<2>().id == 5 && v[5].Get<0>() == SIZE - 5);
+        v[5] = std::make_tuple(-1, -1.0, Obj(-1));
+        assert(v[5].Get<0>() == -1 && v[5].Get<2>().id == -1);
+
+        const SoaVector<int, double, Obj> copy = v;
+        assert(copy.Size() == v.Size() && copy[5].Get<2>().id == -1);
+
+        // Аргументы могут ссылаться на элементы самого вектора при росте
+        SoaVector<int, std::string> strings;
+        strings.EmplaceBack(1, std::string(100, 'x'));
+        strings.EmplaceBack(strings[0].Get<0>(), strings[0].Get<1>());
+        assert(strings.Capacity() == 2);
+        assert(strings[1].Get<1>() == std::string(100, 'x'));
+
+        // Копирование строк через прокси не трогает источник, перемещение — только явное
+        SoaVector<int, std::string> names;
+        for (int i = 0; i < 4; ++i) {
+            names.EmplaceBack(i, std::string(20, static_cast<char>('a' + i)));
+        }
+        const std::tuple<int, std::string> name = names[0];
+        assert(std::get<1>(name) == names[0].Get<1>() && !names[0].Get<1>().empty());
+        SoaVector<int, std::string> targets(4);
+        targets[0] = names[0];
+        assert(targets[0] == names[0] && names[0].Get<1>() == std::string(20, 'a'));
+        std::copy(names.begin(), names.end(), targets.begin());
+        for (int i = 0; i < 4; ++i) {
+            assert(names[i].Get<1>() == std::string(20, static_cast<char>('a' + i)));
+            assert(targets[i] == names[i]);
+        }
+        const std::tuple<int, std::string> taken = iter_move(targets.begin() + 1);
+        assert(std::get<1>(taken) == std::string(20, 'b') && targets[1].Get<1>().empty());
+        targets[1] = targets[2].MoveOut();
+        assert(targets[1].Get<1>() == std::string(20, 'c') && targets[2].Get<1>().empty());
+        std::sort(names.begin(), names.end(), [](const auto& lhs, const auto& rhs) {
+            return GetField<0>(lhs) > GetField<0>(rhs);
+        });
+        assert(names[0].Get<0>() == 3 && names[0].Get<1>() == std::string(20, 'd'));
+        assert(names[3].Get<0>() == 0 && names[3].Get<1>() == std::string(20, 'a'));
+
+        v.Resize(10);
+        assert(v.Size() == 10);
+        v.Resize(20);
+        assert(v[19].Get<0>() == 0 && v[19].Get<2>().id == 0);
+        v.PopBack();
+        assert(v.Size() == 19);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Исключение при копировании столбца при росте не меняет вектор
+        Obj::ResetCounters();
+        SoaVector<Obj, FlakyCopy> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i, i);
+        }
+        FlakyCopy::copies_until_throw = 3;
+        try {
+            v.EmplaceBack(4, 4);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        FlakyCopy::copies_until_throw = 0;
+        assert(v.Size() == 4 && v.Capacity() == 4);
+        assert(Obj::num_moved == 0);
+        for (int i = 0; i < 4; ++i) {
+            assert(v[i].Get<0>().id == i && v[i].Get<1>().value == i);
+        }
+        assert(Obj::GetAliveObjectCount() == 4);
+
+        v.EmplaceBack(4, 4);
+        assert(v.Size() == 5 && v[4].Get<1>().value == 4);
+        assert(v[0].Get<0>().id == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Столбец без копирования с бросающим перемещением даёт базовую гарантию:
+        // элементы не теряются и не разрушаются дважды, размер сохраняется
+        Obj::ResetCounters();
+        {
+            SoaVector<Obj, FlakyMove, std::string> v;
+            v.Reserve(4);
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i, i, std::string(20, 'x'));
+            }
+            FlakyMove::moves_until_throw = 3;
+            try {
+                v.Reserve(8);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            FlakyMove::moves_until_throw = 0;
+            assert(v.Size() == 4 && v.Capacity() == 4);
+            for (int i = 0; i < 4; ++i) {
+                assert(v[i].Get<0>().id == i && v[i].Get<2>() == std::string(20, 'x'));
+            }
+            assert(Obj::GetAliveObjectCount() == 4);
+
+            v.Reserve(8);
+            assert(v.Size() == 4 && v.Capacity() == 8 && v[3].Get<1>().value == 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(FlakyMove::alive == 0);
+    }
+}
+
+template <typename T, typename Alloc>
+void CheckSimdKernels(const Vector<T, Alloc>& v) {
+    const T* first = v.Data();
+    const T* last = v.Data() + v.Size();
+    for (const T value : {T(0), T(3), T(100), T(-1)}) {
+        assert(simd::Find(v, value) == std::find(first, last, value));
+        assert(simd::Count(v, value) == static_cast<size_t>(std::count(first, last, value)));
+        assert(simd::Contains(v, value) == (std::find(first, last, value) != last));
+        assert(simd::Count(first, last, value) == simd::Count(v, value));
+    }
+    if constexpr (std::is_integral_v<T>) {
+        assert(simd::Sum(v) == static_cast<T>(std::accumulate(first, last, T{})));
+    } else {
+        // Целые значения в пределах точности суммируются без округления
+        assert(simd::Sum(v) == std::accumulate(first, last, T{}));
+    }
+    if (v.Size() > 0) {
+        const auto [min, max] = std::minmax_element(first, last);
+        assert(simd::MinMax(v) == std::make_pair(*min, *max));
+    }
+    Vector<T, Alloc> copy(v);
+    assert(simd::Equal(v, copy));
+    if (copy.Size() > 0) {
+        copy[copy.Size() - 1] = T(copy[copy.Size() - 1] + 1);
+        assert(!simd::Equal(v, copy));
+        assert(simd::Equal(first, last - 1, copy.Data()));
+    }
+    simd::Fill(copy, T(7));
+    assert(std::all_of(copy.begin(), copy.end(), [](T x) {
+        return x == T(7);
+    }));
+}
+
+template <typename T>
+void CheckSimdKernels() {
+    std::mt19937 random(42);
+    for (const size_t size : {0, 1, 5, 31, 64, 65, 127, 1000, 4099}) {
+        Vector<T> v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(static_cast<T>(random() % 200) - T(50));
+        }
+        CheckSimdKernels(v);
+        Vector<T, AlignedAllocator<T, 64>> aligned(v.begin(), v.end());
+        CheckSimdKernels(aligned);
+    }
+}
+
+#ifdef VECTOR_HAS_CONSTEXPR
+// Первые Count простых чисел. Вектор растёт от нулевой ёмкости, удваивая буфер
+template <size_t Count>
+constexpr std::array<int, Count> MakePrimes() {
+    Vector<int> primes;
+    for (int n = 2; primes.Size() < Count; ++n) {
+        bool is_prime = true;
+        for (const int p : primes) {
+            if (p * p > n) {
+                break;
+            }
+            if (n % p == 0) {
+                is_prime = false;
+                break;
+            }
+        }
+        if (is_prime) {
+            primes.PushBack(n);
+        }
+    }
+    std::array<int, Count> result{};
+    std::copy(primes.begin(), primes.end(), result.begin());
+    return result;
+}
+
+// Вложенные векторы не тривиально перемещаемы: при росте они переносятся конструктором перемещения
+constexpr int NestedSum() {
+    Vector<Vector<int>> rows;
+    for (size_t i = 0; i < 5; ++i) {
+        Vector<int> row(i);
+        for (size_t j = 0; j < i; ++j) {
+            row[j] = static_cast<int>(j + 1);
+        }
+        rows.EmplaceBack(std::move(row));
+    }
+    Vector<Vector<int>> copy(rows);
+    copy.PopBack();
+    rows = copy;
+    rows.Reserve(16);
+    rows.Resize(6);
+    int sum = 0;
+    for (const Vector<int>& row : rows) {
+        for (const int x : row) {
+            sum += x;
+        }
+    }
+    return sum;
+}
+#endif
+
+void Test27() {
+    const SimdLevel detected = DetectSimdLevel();
+    assert(GetSimdLevel() == detected);
+    for (const SimdLevel level : {SimdLevel::kScalar, SimdLevel::kSse2, SimdLevel::kAvx2
+                                  , SimdLevel::kAvx512, SimdLevel::kNeon}) {
+        const SimdLevel active = SetSimdLevel(level);
+        assert(active == level || active == detected);
+        assert(GetSimdLevel() == active);
+
+        CheckSimdKernels<uint8_t>();
+        CheckSimdKernels<int8_t>();
+        CheckSimdKernels<int16_t>();
+        CheckSimdKernels<uint32_t>();
+        CheckSimdKernels<int32_t>();
+        CheckSimdKernels<int64_t>();
+        CheckSimdKernels<float>();
+        CheckSimdKernels<double>();
+
+        // Счётчики дорожек не переполняются на длинных диапазонах
+        Vector<uint8_t> bytes(100'000);
+        assert(simd::Count(bytes, 0) == 100'000);
+        bytes[99'999] = 1;
+        assert(simd::Find(bytes, 1) == bytes.Data() + 99'999);
+        assert(simd::Sum(bytes) == 1);
+
+        // Сравнение по ==, как у std::equal: NaN не равен себе, а -0.0 равен 0.0
+        Vector<double> nan(3);
+        nan[1] = std::numeric_limits<double>::quiet_NaN();
+        assert(!simd::Equal(nan, nan));
+        assert(!simd::Contains(nan, std::numeric_limits<double>::quiet_NaN()));
+        Vector<double> zeros(100);
+        Vector<double> negative_zeros(100);
+        simd::Fill(negative_zeros, -0.0);
+        assert(simd::Equal(zeros, negative_zeros));
+    }
+    SetSimdLevel(detected);
+}
+
+void Test28() {
+#ifdef VECTOR_HAS_CONSTEXPR
+    // Таблица вычисляется во время компиляции, а буфер вектора освобождается там же
+    constexpr std::array<int, 10> kPrimes = MakePrimes<10>();
+    static_assert(kPrimes[0] == 2 && kPrimes[9] == 29);
+    static_assert(NestedSum() == 0 + 1 + 3 + 6);
+
+    // Те же функции работают и во время выполнения
+    assert(MakePrimes<10>() == kPrimes);
+    assert(NestedSum() == 10);
+#endif
+}
+
+void Test29() {
+    static_assert(std::is_trivially_copyable_v<InplaceVector<int, 8>>);
+    static_assert(!std::is_trivially_copyable_v<InplaceVector<std::string, 8>>);
+    static_assert(InplaceVector<int, 8>::Capacity() == 8);
+    {
+        // Ни одна операция не выделяет память
+        const size_t allocations = num_allocations;
+        InplaceVector<int, 8> v;
+        for (int i = 0; i < 8; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.TryEmplaceBack(8) == nullptr);
+        assert(v.TryPushBack(8) == nullptr && v.Size() == 8);
+        v.Erase(v.cbegin() + 2, v.cbegin() + 4);
+        assert(v.Size() == 6 && v[2] == 4 && v[5] == 7);
+        assert(*v.Emplace(v.cbegin() + 1, 100) == 100);
+        assert(v[0] == 0 && v[1] == 100 && v[2] == 1 && v[6] == 7);
+        v.Resize(3);
+        assert(v.Size() == 3 && v[2] == 1);
+        assert(*v.TryPushBack(5) == 5);
+
+        // Тривиально копируемый вектор копируется целиком, как обычная структура
+        InplaceVector<int, 8> copy;
+        std::memcpy(static_cast<void*>(&copy), &v, sizeof(v));
+        assert(copy.Size() == 4 && std::equal(copy.begin(), copy.end(), v.begin()));
+        assert(num_allocations == allocations);
+    }
+    {
+        InplaceVector<int, 4> v(4);
+        try {
+            v.EmplaceBack(1);
+            assert(false);
+        } catch (const std::bad_alloc&) {
+        }
+        try {
+            v.Insert(v.cbegin(), 1);
+            assert(false);
+        } catch (const std::bad_alloc&) {
+        }
+        try {
+            v.Resize(5);
+            assert(false);
+        } catch (const std::bad_alloc&) {
+        }
+        assert(v.Size() == 4 && std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 0;
+        }));
+    }
+    {
+        Obj::ResetCounters();
+        {
+            InplaceVector<Obj, 10> v;
+            for (int i = 0; i < 5; ++i) {
+                v.EmplaceBack(i);
+            }
+            // Вставка в середину сдвигает хвост перемещением
+            v.Emplace(v.cbegin() + 1, 10);
+            assert(v.Size() == 6 && v[1].id == 10 && v[2].id == 1 && v[5].id == 4);
+            assert(Obj::num_copied == 0);
+
+            // Исключение в конструкторе элемента оставляет вектор прежним
+            Obj thrower(42);
+            thrower.throw_on_copy = true;
+            try {
+                v.Insert(v.cbegin() + 2, thrower);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 6 && v[2].id == 1);
+            try {
+                v.TryPushBack(thrower);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+
+            v.Erase(v.cbegin());
+            assert(v.Size() == 5 && v[0].id == 10);
+
+            InplaceVector<Obj, 10> copy(v);
+            assert(Obj::num_copied == 5);
+            InplaceVector<Obj, 10> other;
+            other.EmplaceBack(7);
+            other.Swap(copy);
+            assert(other.Size() == 5 && copy.Size() == 1 && copy[0].id == 7 && other[0].id == 10);
+            copy = other;
+            assert(copy.Size() == 5 && copy[4].id == 4);
+            other.Clear();
+            assert(other.Size() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+// События перевыделения, полученные функцией трассировки
+Vector<ReallocationEvent> trace_events;
+
+void RecordReallocation(const ReallocationEvent& event) {
+    trace_events.PushBack(event);
+}
+
+void Test30() {
+    using TracedVector = Vector<int, std::allocator<int>, DoublingGrowth, TracingStats<InstanceStats>>;
+    assert(SetTraceCallback(RecordReallocation) == nullptr);
+    {
+        TracedVector v;
+        v.Reserve(4);
+        assert(trace_events.Size() == 1);
+        assert(trace_events[0].old_capacity == 0 && trace_events[0].new_capacity == 4);
+        assert(trace_events[0].bytes_moved == 0 && trace_events[0].elem_size == sizeof(int));
+
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
+        }
+        assert(trace_events.Size() == 2);
+        assert(trace_events[1].old_capacity == 4 && trace_events[1].new_capacity == 8);
+        assert(trace_events[1].bytes_moved == 4 * sizeof(int));
+
+        v.Insert(v.cbegin(), 4, -1);
+        assert(trace_events.Size() == 3 && trace_events[2].bytes_moved == 5 * sizeof(int));
+        v.Emplace(v.cbegin() + 1, 7);
+        v.ShrinkToFit();
+        assert(trace_events.Size() == 4);
+        assert(trace_events[3].old_capacity == 16 && trace_events[3].new_capacity == 10);
+
+        v.Reserve(5);
+        assert(trace_events.Size() == 4);
+        // Счётчики базовой политики продолжают работать
+        assert(v.GetStats().Snapshot().allocations == 4);
+    }
+    // Разрушение вектора освобождает буфер
+    assert(trace_events.Size() == 5);
+    assert(trace_events[4].old_capacity == 10 && trace_events[4].new_capacity == 0);
+
+    // Без функции трассировки события никуда не передаются
+    assert(SetTraceCallback(nullptr) == RecordReallocation);
+    {
+        TracedVector v(100);
+        v.PushBack(1);
+    }
+    assert(trace_events.Size() == 5);
+    trace_events.ReleaseMemory();
+}
+
+void Test31() {
+    {
+        // Буфер переходит из вектора в вектор без копирования и перемещения элементов
+        Obj::ResetCounters();
+        Vector<Obj> source;
+        source.Reserve(8);
+        for (int i = 0; i < 5; ++i) {
+            source.EmplaceBack(i);
+        }
+        const Obj* data = source.Data();
+        VectorBuffer<Obj> buffer = source.ReleaseBuffer();
+        assert(source.Size() == 0 && source.Capacity() == 0);
+        assert(buffer.data == data && buffer.size == 5 && buffer.capacity == 8);
+
+        Vector<Obj> target;
+        target.EmplaceBack(100);
+        target.AdoptBuffer(buffer);
+        assert(target.Data() == data && target.Size() == 5 && target.Capacity() == 8);
+        assert(target[4].id == 4);
+        assert(Obj::num_copied == 0 && Obj::num_moved == 0 && Obj::num_destroyed == 1);
+
+        // Отданный буфер можно освободить вручную
+        buffer = target.ReleaseBuffer();
+        std::destroy_n(buffer.data, buffer.size);
+        std::allocator<Obj>().deallocate(buffer.data, buffer.capacity);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Копирующее присваивание выделяет один буфер и сохраняет вектор при исключении
+        Vector<Obj> small;
+        small.EmplaceBack(1);
+        Vector<Obj> large;
+        for (int i = 0; i < 10; ++i) {
+            large.EmplaceBack(i);
+        }
+        const size_t allocations = num_allocations;
+        small = large;
+        assert(num_allocations == allocations + 1);
+        assert(small.Size() == 10 && small.Capacity() == 10 && small[9].id == 9);
+
+        Vector<Obj> one;
+        one.EmplaceBack(42);
+        large.EmplaceBack(10);
+        large[5].throw_on_copy = true;
+        try {
+            one = large;
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(one.Size() == 1 && one[0].id == 42);
+    }
+    {
+        // Рабочий вектор запроса в установившемся режиме не выделяет память
+        detail::RecyclingCache::Trim();
+        const auto handle_request = [](int seed) {
+            RecyclingVector<int> scratch;
+            for (int i = 0; i < 1000; ++i) {
+                scratch.PushBack(seed + i);
+            }
+            RecyclingVector<int> copy;
+            copy = scratch;
+            return std::accumulate(copy.begin(), copy.end(), 0);
+        };
+        handle_request(0);
+        const size_t allocations = num_allocations;
+        for (int i = 0; i < 100; ++i) {
+            assert(handle_request(i) == 1000 * i + 999 * 1000 / 2);
+        }
+        assert(num_allocations == allocations);
+        assert(detail::RecyclingCache::CachedBlocks() > 0);
+
+        // Ёмкость равна классу размеров блока
+        {
+            RecyclingVector<int> v;
+            v.Reserve(100);
+            assert(v.Capacity() == 512 / sizeof(int));
+            RecyclingVector<int> adopted;
+            adopted.AdoptBuffer(v.ReleaseBuffer());
+            assert(adopted.Capacity() == 512 / sizeof(int));
+        }
+
+        // Кэш другого потока очищается при его завершении
+        std::thread worker([&handle_request] {
+            handle_request(1);
+            assert(detail::RecyclingCache::CachedBlocks() > 0);
+        });
+        worker.join();
+
+        detail::RecyclingCache::Trim();
+        assert(detail::RecyclingCache::CachedBlocks() == 0);
+    }
+}
+
+template <typename Search>
+void CheckFlatSet() {
+    std::mt19937 random(7);
+    std::set<int> expected;
+    FlatSet<int, std::less<int>, std::allocator<int>, Search> set;
+    for (const size_t batch : {0, 1, 7, 100, 1000}) {
+        Vector<int> keys;
+        for (size_t i = 0; i < batch; ++i) {
+            keys.PushBack(static_cast<int>(random() % 2000));
+        }
+        set.Insert(keys.begin(), keys.end());
+        expected.insert(keys.begin(), keys.end());
+        assert(set.Size() == expected.size());
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+        for (int key = -1; key <= 2001; ++key) {
+            assert(set.Contains(key) == (expected.count(key) == 1));
+            const auto it = expected.lower_bound(key);
+            assert(set.LowerBound(key) - set.begin() == std::distance(expected.begin(), it));
+        }
+    }
+    assert(set.Insert(5000).second && !set.Insert(5000).second);
+    assert(*set.Find(5000) == 5000 && set.Count(5000) == 1);
+    assert(set.Erase(5000) == 1 && set.Erase(5000) == 0 && !set.Contains(5000));
+    const int first = *set.begin();
+    assert(set.Erase(set.begin()) == set.begin() && !set.Contains(first));
+}
+
+template <typename Search>
+void CheckFlatMap() {
+    FlatMap<std::string, int, std::less<std::string>, std::allocator<std::string>, std::allocator<int>, Search> map;
+    assert(map.Insert("b", 2).second && map.Insert("a", 1).second);
+    assert(!map.Insert("a", 10).second && map.At("a") == 1);
+    map["c"] = 3;
+    assert(map.Size() == 3 && map.Keys()[2] == "c" && map.Values()[2] == 3);
+
+    // Пары диапазона сливаются с прежними: повторы не заменяют существующие значения
+    const std::map<std::string, int> pairs = {{"a", 100}, {"d", 4}, {"e", 5}};
+    map.Insert(pairs.begin(), pairs.end());
+    assert(map.Size() == 5 && map.At("a") == 1 && map.At("e") == 5);
+
+    // Параллельные массивы ключей и значений; из повторов внутри диапазона остаётся первый
+    Vector<std::string> keys;
+    Vector<int> values;
+    for (const char* key : {"z", "f", "f", "b"}) {
+        keys.PushBack(key);
+        values.PushBack(static_cast<int>(values.Size()) + 20);
+    }
+    map.Insert(keys.begin(), keys.end(), values.begin());
+    assert(map.Size() == 7 && map.At("z") == 20 && map.At("f") == 21 && map.At("b") == 2);
+    assert(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+
+    assert(map.Find("q") == nullptr && map.Find("d") != nullptr && *map.Find("d") == 4);
+    try {
+        map.At("q");
+        assert(false);
+    } catch (const std::out_of_range&) {
+    }
+    assert(map.Erase("d") == 1 && map.Erase("d") == 0 && map.Size() == 6);
+    assert(!map.Contains("d") && map.Contains("e") && map.At("e") == 5);
+    *map.TryEmplace("e", 0).first += 1;
+    assert(map.At("e") == 6);
+    map.Clear();
+    assert(map.Empty() && !map.Contains("a"));
+}
+
+void Test32() {
+    CheckFlatSet<BranchlessSearch>();
+    CheckFlatSet<EytzingerSearch>();
+    CheckFlatMap<BranchlessSearch>();
+    CheckFlatMap<EytzingerSearch>();
+
+    // Исключение при массовой вставке очищает контейнер
+    Obj::ResetCounters();
+    {
+        FlatMap<int, Obj> map;
+        map.TryEmplace(1, 1);
+        Vector<int> keys;
+        Vector<Obj> values;
+        for (int i = 0; i < 3; ++i) {
+            keys.PushBack(i + 10);
+            values.EmplaceBack(i);
+        }
+        values[1].throw_on_copy = true;
+        try {
+            map.Insert(keys.begin(), keys.end(), values.begin());
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(map.Empty() && map.Values().Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+// Перемещение не помечено noexcept и может выбросить исключение, как у типов
+// из сторонних библиотек
+struct LegacyMove {
+    explicit LegacyMove(int value = 0)
+        : value(value)  //
+    {
+        ++num_alive;
+    }
+
+    LegacyMove(const LegacyMove& other)
+        : value(other.value)  //
+    {
+        ++num_copied;
+        ++num_alive;
+    }
+
+    LegacyMove(LegacyMove&& other)
+        : value(other.value)  //
+    {
+        if (move_throw_countdown > 0 && --move_throw_countdown == 0) {
+            throw std::runtime_error("Oops");
+        }
+        other.value = -1;
+        ++num_moved;
+        ++num_alive;
+    }
+
+    LegacyMove& operator=(const LegacyMove& rhs) {
+        value = rhs.value;
+        ++num_copied;
+        return *this;
+    }
+
+    LegacyMove& operator=(LegacyMove&& rhs) {
+        value = std::exchange(rhs.value, -1);
+        ++num_moved;
+        return *this;
+    }
+
+    ~LegacyMove() {
+        --num_alive;
+    }
+
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_alive = 0;
+        move_throw_countdown = 0;
+    }
+
+    int value;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_alive = 0;
+    static inline int move_throw_countdown = 0;
+};
+
+void Test33() {
+    using StrongVector = Vector<LegacyMove, std::allocator<LegacyMove>, DoublingGrowth, InstanceStats>;
+    using ForcedVector = Vector<LegacyMove, std::allocator<LegacyMove>, DoublingGrowth, InstanceStats
+                                , ForcedMoveRelocation>;
+    const int SIZE = 100;
+
+    static_assert(!detail::kRelocateByMove<LegacyMove, StrongRelocation>);
+    static_assert(detail::kRelocateByMove<LegacyMove, ForcedMoveRelocation>);
+    static_assert(detail::kRelocateByMove<std::string, NoexceptRelocation>);
+    {
+        LegacyMove::ResetCounters();
+        StrongVector v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(LegacyMove::num_moved == 0);
+        assert(LegacyMove::num_copied == 127);
+        assert(v.GetStats().Snapshot().copy_fallbacks == 127);
+    }
+    {
+        LegacyMove::ResetCounters();
+        ForcedVector v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(LegacyMove::num_copied == 0);
+        assert(LegacyMove::num_moved == 127);
+        const StatsCounters stats = v.GetStats().Snapshot();
+        assert(stats.relocated == 127 && stats.copy_fallbacks == 0);
+
+        // Удаление сдвигает хвост перемещающим присваиванием
+        v.Erase(v.begin());
+        v.EraseIf([](const LegacyMove& item) {
+            return item.value % 2 == 0;
+        });
+        v.UnorderedErase(v.begin());
+        assert(LegacyMove::num_copied == 0);
+        assert(v.Size() == SIZE / 2 - 1);
+        assert(v[0].value == SIZE - 1 && v[1].value == 3);
+        assert(LegacyMove::num_alive == static_cast<int>(v.Size()));
+    }
+    {
+        // Базовая гарантия: размер и ёмкость не меняются, элементы остаются живыми,
+        // но часть из них может оказаться в состоянии после перемещения
+        LegacyMove::ResetCounters();
+        ForcedVector v;
+        v.Reserve(8);
+        for (int i = 0; i < 8; ++i) {
+            v.EmplaceBack(i);
+        }
+        LegacyMove::move_throw_countdown = 3;
+        try {
+            v.EmplaceBack(8);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 8 && v.Capacity() == 8);
+        assert(LegacyMove::num_alive == 8);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].value == static_cast<int>(i) || v[i].value == -1);
+        }
+
+        // Исключение при переносе элементов после позиции вставки
+        LegacyMove::move_throw_countdown = 6;
+        try {
+            v.Emplace(v.begin() + 4, 100);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 8 && v.Capacity() == 8);
+        assert(LegacyMove::num_alive == 8);
+
+        LegacyMove::move_throw_countdown = 2;
+        try {
+            v.Reserve(SIZE);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 8 && v.Capacity() == 8);
+        assert(LegacyMove::num_alive == 8);
+    }
+    assert(LegacyMove::num_alive == 0);
+    {
+        Vector<std::string, std::allocator<std::string>, DoublingGrowth, NoStats, NoexceptRelocation> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Insert(v.begin(), "first");
+        assert(v.Size() == SIZE + 1 && v[0] == "first" && v[SIZE] == std::to_string(SIZE - 1));
+    }
+}
+
+// Выполняет check в дочернем процессе и возвращает true, если тот завершился аварийно
+template <typename F>
+bool Dies(F check) {
+    std::cout.flush();
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        // Сообщение о нарушении не попадает в вывод тестов
+        static_cast<void>(std::freopen("/dev/null", "w", stderr));
+        check();
+        ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+#ifdef VECTOR_HAS_ASAN_ANNOTATIONS
+// Запас ёмкости отмечен недоступным так же, как его размечает Vector: неполная последняя
+// 8-байтовая гранула остаётся доступной
+template <typename V>
+bool IsSpareAnnotated(const V& v) {
+    using T = typename V::value_type;
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(v.Data());
+    const uintptr_t end = (begin + v.Capacity() * sizeof(T)) & ~uintptr_t{7};
+    if (v.Data() == nullptr || begin >= end) {
+        return true;
+    }
+    const uintptr_t mid = std::min(begin + v.Size() * sizeof(T), end);
+    return __sanitizer_verify_contiguous_container(reinterpret_cast<const void*>(begin)
+                                                   , reinterpret_cast<const void*>(mid)
+                                                   , reinterpret_cast<const void*>(end)) != 0;
+}
+#endif
+
+void Test34() {
+    const int SIZE = 37;
+    {
+        Vector<int> v;
+        assert(v.Data() == nullptr);
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        const Vector<int>& cv = v;
+        assert(v.Data() == &v[0] && cv.Data() == v.Data());
+        assert(&*v.begin() == v.Data() && &*(v.end() - 1) == v.Data() + SIZE - 1);
+    }
+#ifdef VECTOR_HAS_ASAN_ANNOTATIONS
+    {
+        Vector<int> v;
+        v.Reserve(100);
+        assert(IsSpareAnnotated(v));
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+            assert(IsSpareAnnotated(v));
+        }
+        v.Resize(50);
+        assert(IsSpareAnnotated(v));
+        v.Resize(20);
+        assert(IsSpareAnnotated(v));
+        v.Insert(v.begin() + 3, 7);
+        v.Insert(v.begin(), 5, 1);
+        assert(IsSpareAnnotated(v));
+        v.Erase(v.begin(), v.begin() + 10);
+        v.EraseIf([](int value) {
+            return value % 2 != 0;
+        });
+        v.UnorderedErase(v.begin());
+        v.PopBack();
+        assert(IsSpareAnnotated(v));
+
+        Vector<int> other(v);
+        assert(IsSpareAnnotated(other));
+        other.Reserve(1000);
+        v.Swap(other);
+        assert(IsSpareAnnotated(v) && IsSpareAnnotated(other));
+        other = std::move(v);
+        assert(IsSpareAnnotated(v) && IsSpareAnnotated(other));
+        other.ShrinkToFit();
+        assert(IsSpareAnnotated(other));
+        other.Clear();
+        assert(IsSpareAnnotated(other));
+
+        Vector<std::string> strings;
+        for (int i = 0; i < SIZE; ++i) {
+            strings.PushBack(std::to_string(i));
+        }
+        strings.Erase(strings.begin() + 10, strings.end());
+        assert(IsSpareAnnotated(strings));
+    }
+    {
+        // Чтение за последним элементом — ошибка container-overflow
+        Vector<int> v;
+        v.Reserve(16);
+        v.PushBack(1);
+        assert(Dies([&] {
+            static_cast<void>(*static_cast<volatile const int*>(v.Data() + 1));
+        }));
+    }
+#endif
+#ifdef VECTOR_CHECK_ITERATORS
+    {
+        Vector<int> v(4);
+        Vector<int>::iterator it = v.begin();
+        v.Reserve(v.Capacity() * 2);
+        assert(Dies([&] {
+            static_cast<void>(*it);
+        }));
+        assert(Dies([&] {
+            static_cast<void>(*v.end());
+        }));
+        Vector<int> other(4);
+        assert(Dies([&] {
+            v.Erase(other.begin());
+        }));
+        Vector<int>::iterator last = v.end() - 1;
+        v.PopBack();
+        assert(Dies([&] {
+            static_cast<void>(*last);
+        }));
+
+        // Без перевыделения итераторы остаются действительными
+        Vector<int>::iterator first = v.begin();
+        v.PushBack(1);
+        assert(*first == 0 && first == v.begin());
+    }
+#endif
+#if VECTOR_BOUNDS_CHECK == 2
+    {
+        Vector<int> v(3);
+        assert(Dies([&] {
+            static_cast<void>(v[v.Size()]);
+        }));
+    }
+#endif
+}
+
+void Test35() {
+    using counting::Budget;
+    using counting::CheckBudget;
+    using counting::Counted;
+    const size_t SIZE = 100;
+
+    Counted::ResetCounters();
+    {
+        Vector<Counted> v;
+        const Counted first(0);
+        const Counted value(-1);
+        CheckBudget("Reserve of an empty vector", Budget().Allocations(1).Constructions(0), [&] {
+            v.Reserve(SIZE);
+        });
+        CheckBudget("PushBack after Reserve", Budget().Allocations(0).Constructions(1).Copies(1), [&] {
+            v.PushBack(first);
+        });
+        CheckBudget("EmplaceBack after Reserve", Budget().Allocations(0).Constructions(1).Copies(0).Moves(0), [&] {
+            v.EmplaceBack(0);
+        });
+        for (int i = 1; v.Size() < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+
+        // При перевыделении элементы перемещаются, копируется только добавляемый
+        CheckBudget("PushBack into a full vector", Budget().Allocations(1).Constructions(SIZE + 1).Copies(1)
+                    .Destructions(SIZE), [&] {
+            v.PushBack(value);
+        });
+        CheckBudget("PopBack", Budget().Allocations(0).Constructions(0).Destructions(1), [&] {
+            v.PopBack();
+        });
+        CheckBudget("Reserve of a filled vector", Budget().Allocations(1).Copies(0).Moves(SIZE)
+                    .Destructions(SIZE), [&] {
+            v.Reserve(SIZE * 4);
+        });
+        CheckBudget("Insert at the front with spare capacity", Budget().Allocations(0).Constructions(2)
+                    .Assignments(SIZE).Destructions(1), [&] {
+            v.Insert(v.begin(), value);
+        });
+        CheckBudget("Erase at the front", Budget().Allocations(0).Constructions(0).Assignments(SIZE)
+                    .Destructions(1), [&] {
+            v.Erase(v.begin());
+        });
+        CheckBudget("Insert of a count with spare capacity", Budget().Allocations(0).Constructions(SIZE)
+                    .Destructions(0), [&] {
+            v.Insert(v.begin() + SIZE / 2, SIZE, value);
+        });
+        CheckBudget("EraseIf", Budget().Allocations(0).Constructions(0).Assignments(SIZE)
+                    .Destructions(SIZE), [&] {
+            v.EraseIf([](const Counted& item) {
+                return item.value == -1;
+            });
+        });
+        assert(v.Size() == SIZE);
+
+        Vector<Counted> copy;
+        CheckBudget("copy construction", Budget().Allocations(1).Constructions(SIZE).Copies(SIZE), [&] {
+            Vector<Counted> temp(v);
+            copy.Swap(temp);
+        });
+        CheckBudget("copy assignment with enough capacity", Budget().Allocations(0).Constructions(0)
+                    .Assignments(SIZE), [&] {
+            copy = v;
+        });
+        CheckBudget("move construction and Swap", Budget().Allocations(0).Constructions(0).Assignments(0)
+                    .Destructions(0), [&] {
+            Vector<Counted> moved(std::move(copy));
+            moved.Swap(v);
+            v.Swap(moved);
+            copy = std::move(moved);
+        });
+        CheckBudget("Resize within capacity", Budget().Allocations(0).Constructions(SIZE).Copies(0)
+                    .Moves(0), [&] {
+            v.Resize(SIZE * 2);
+        });
+        CheckBudget("Clear", Budget().Allocations(0).Constructions(0).Destructions(SIZE * 2), [&] {
+            v.Clear();
+        });
+    }
+    {
+        // Удвоение ёмкости: 1, 2, 4, ..., 1024 — 11 выделений на 1000 элементов,
+        // при которых перемещаются 1 + 2 + ... + 512 = 1023 элемента
+        const size_t COUNT = 1000;
+        Vector<Counted> v;
+        CheckBudget("growth by PushBack", Budget().Allocations(11).Copies(0).Moves(1023), [&] {
+            for (size_t i = 0; i < COUNT; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+        });
+
+        SmallVector<Counted, 8> small;
+        CheckBudget("SmallVector within the inline buffer", Budget().Allocations(0), [&] {
+            for (int i = 0; i < 8; ++i) {
+                small.EmplaceBack(i);
+            }
+        });
+
+        // Буфер в динамической памяти переходит при перемещении и обмене целиком
+        SmallVector<Counted, 4> large;
+        for (int i = 0; i < 1000; ++i) {
+            large.EmplaceBack(i);
+        }
+        const Counted* data = large.Data();
+        CheckBudget("SmallVector move of a heap buffer", Budget().Allocations(0).Constructions(0), [&] {
+            const SmallVector<Counted, 4> moved(std::move(large));
+            assert(moved.Data() == data && moved.Size() == 1000);
+        });
+        assert(large.Size() == 0 && large.IsInline() && large.Capacity() == 4);
+
+        SmallVector<Counted, 4> other(1000);
+        data = other.Data();
+        CheckBudget("SmallVector move assignment of a heap buffer",
+                    Budget().Allocations(0).Constructions(0).Assignments(0), [&] {
+            large = std::move(other);
+        });
+        assert(large.Data() == data && other.IsInline() && other.Size() == 0);
+
+        other.Resize(2000);
+        const Counted* other_data = other.Data();
+        CheckBudget("SmallVector Swap of heap buffers",
+                    Budget().Allocations(0).Constructions(0).Assignments(0), [&] {
+            large.Swap(other);
+        });
+        assert(large.Data() == other_data && large.Size() == 2000);
+        assert(other.Data() == data && other.Size() == 1000);
+    }
+    assert(Counted::counters.Alive() == 0);
+
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+        counting::FuzzAgainstStdVector<Vector<Counted>>(seed, 2000);
+        counting::FuzzAgainstStdVector<Vector<int>>(seed, 2000);
+        counting::FuzzAgainstStdVector<Vector<Counted, std::allocator<Counted>, GoldenGrowth, NoStats
+                                              , ForcedMoveRelocation>>(seed, 2000);
+        counting::FuzzAgainstStdVector<SmallVector<Counted, 4>>(seed, 2000, 16);
+    }
+    assert(Counted::counters.Alive() == 0);
+}
+
+int main() {
+    try {
+        Test1();
+        Test2();
+        Test3();
+        Test4();
+        Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
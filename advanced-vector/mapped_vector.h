@@ -0,0 +1,388 @@
+#pragma once
+#include "vector.h"
+#include "vector_io.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Заголовок файла с элементами вектора. Элементы начинаются со смещения data_offset
+// и занимают capacity ячеек, из которых первые size заполнены. Числа записаны в порядке
+// байтов машины, сохранившей файл; endianness позволяет его проверить
+struct MappedVectorHeader {
+    static constexpr char kMagic[8] = {'A', 'V', 'E', 'C', 'T', 'O', 'R', '\0'};
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kEndianness = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t endianness;
+    uint64_t data_offset;
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t elem_size;
+    uint64_t alignment;
+    uint64_t fingerprint;
+};
+
+static_assert(sizeof(MappedVectorHeader) == 64 && std::is_trivially_copyable_v<MappedVectorHeader>);
+
+// Отпечаток типа элементов, записываемый в файл: файл открывается только тем же типом.
+// По умолчанию это FNV-1a от категории типа (целый со знаком или без, с плавающей точкой,
+// перечисление, класс), sizeof и alignof — он не зависит от компилятора и его версии.
+// Классы одного размера и выравнивания по умолчанию не различаются; чтобы различать их
+// и менять отпечаток вместе с раскладкой типа, задайте свой тег специализацией:
+//     template <> struct TypeFingerprint<MyType> {
+//         static uint64_t Get() noexcept { return 0x4d79547970650002; }  // "MyType", версия 2
+//     };
+template <typename T>
+struct TypeFingerprint {
+    static uint64_t Get() noexcept {
+        uint64_t hash = 14695981039346656037ull;
+        const auto mix = [&hash](uint64_t value) {
+            for (int i = 0; i < 8; ++i, value >>= 8) {
+                hash = (hash ^ (value & 0xff)) * 1099511628211ull;
+            }
+        };
+        using Element = std::remove_all_extents_t<T>;
+        uint64_t kind = 0;
+        if constexpr (std::is_enum_v<Element>) {
+            kind = 1;
+        } else if constexpr (std::is_floating_point_v<Element>) {
+            kind = 2;
+        } else if constexpr (std::is_integral_v<Element>) {
+            kind = std::is_signed_v<Element> ? 3 : 4;
+        } else if constexpr (std::is_pointer_v<Element>) {
+            kind = 5;
+        } else {
+            kind = 6;
+        }
+        mix(kind);
+        mix(sizeof(Element));
+        mix(sizeof(T));
+        mix(alignof(T));
+        return hash;
+    }
+};
+
+// Режим OpenMapped. Режимы — теги разных типов, поэтому от режима зависит тип результата
+struct MapMode {
+    // Страницы доступны только для чтения, OpenMapped возвращает MappedView
+    struct ReadOnlyT {
+        explicit ReadOnlyT() = default;
+    };
+
+    // Запись создаёт частные копии страниц, файл не меняется. OpenMapped возвращает MappedVector
+    struct CopyOnWriteT {
+        explicit CopyOnWriteT() = default;
+    };
+
+    static constexpr ReadOnlyT kReadOnly{};
+    static constexpr CopyOnWriteT kCopyOnWrite{};
+};
+
+namespace detail {
+
+// Отображение файла, общее для копий MappedFileAllocator
+class MappedRegion {
+public:
+    MappedRegion(void* base, size_t length) noexcept
+        : base_(base)
+        , length_(length) {
+    }
+
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+
+    ~MappedRegion() {
+        Unmap();
+    }
+
+    bool Contains(const void* p) const noexcept {
+        const char* begin = static_cast<const char*>(base_);
+        return base_ != nullptr && p >= begin && p <= begin + length_;
+    }
+
+    void Unmap() noexcept {
+        if (base_ != nullptr) {
+            ::munmap(base_, length_);
+            base_ = nullptr;
+        }
+    }
+
+private:
+    void* base_;
+    size_t length_;
+};
+
+// Сбрасывает на диск каталог, содержащий path, чтобы переименование в нём пережило сбой
+inline void SyncParentDirectory(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    const std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        ThrowSystemError("open " + directory);
+    }
+    if (::fsync(fd) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        ThrowSystemError("fsync " + directory);
+    }
+    ::close(fd);
+}
+
+template <typename T>
+constexpr uint64_t MappedDataOffset() noexcept {
+    constexpr size_t alignment = std::max<size_t>(alignof(T), 64);
+    return (sizeof(MappedVectorHeader) + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace detail
+
+// Аллокатор вектора, открытого поверх отображённого файла. Буфер из файла освобождается
+// через munmap, а новые буферы (при росте сверх ёмкости файла) выделяются через operator new.
+// Копия вектора получает аллокатор без отображения
+template <typename T>
+class MappedFileAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    MappedFileAllocator() = default;
+
+    explicit MappedFileAllocator(std::shared_ptr<detail::MappedRegion> region) noexcept
+        : region_(std::move(region)) {
+    }
+
+    template <typename U>
+    MappedFileAllocator(const MappedFileAllocator<U>& other) noexcept
+        : region_(other.GetRegion()) {
+    }
+
+    T* allocate(size_t n) {
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (region_ != nullptr && region_->Contains(p)) {
+            region_->Unmap();
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    MappedFileAllocator select_on_container_copy_construction() const noexcept {
+        return MappedFileAllocator();
+    }
+
+    const std::shared_ptr<detail::MappedRegion>& GetRegion() const noexcept {
+        return region_;
+    }
+
+    template <typename U>
+    bool operator==(const MappedFileAllocator<U>& other) const noexcept {
+        return region_ == other.GetRegion();
+    }
+
+    template <typename U>
+    bool operator!=(const MappedFileAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    std::shared_ptr<detail::MappedRegion> region_;
+};
+
+template <typename T>
+using MappedVector = Vector<T, MappedFileAllocator<T>>;
+
+// Вектор поверх отображения, открытого только для чтения. Страницы защищены от записи,
+// поэтому доступен только константный интерфейс Vector. Изменяемую копию даёт ToVector,
+// а изменяемое отображение — OpenMapped в режиме MapMode::kCopyOnWrite
+template <typename T>
+class MappedView {
+public:
+    using value_type = T;
+    using iterator = typename MappedVector<T>::const_iterator;
+    using const_iterator = typename MappedVector<T>::const_iterator;
+
+    explicit MappedView(MappedVector<T>&& vector) noexcept
+        : vector_(std::move(vector)) {
+    }
+
+    MappedView(const MappedView&) = delete;
+    MappedView& operator=(const MappedView&) = delete;
+    MappedView(MappedView&&) noexcept = default;
+    MappedView& operator=(MappedView&&) noexcept = default;
+
+    size_t Size() const noexcept {
+        return vector_.Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return vector_.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return vector_[index];
+    }
+
+    const T* Data() const noexcept {
+        return vector_.Data();
+    }
+
+    const_iterator begin() const noexcept {
+        return vector_.begin();
+    }
+    const_iterator end() const noexcept {
+        return vector_.end();
+    }
+    const_iterator cbegin() const noexcept {
+        return vector_.cbegin();
+    }
+    const_iterator cend() const noexcept {
+        return vector_.cend();
+    }
+
+    // Копирует элементы в обычную память
+    Vector<T> ToVector() const {
+        return Vector<T>(vector_.Data(), vector_.Data() + vector_.Size());
+    }
+
+private:
+    MappedVector<T> vector_;
+};
+
+// Сохраняет элементы вектора в файл path. Файл получает ёмкость вектора: свободные ячейки
+// не записываются, а добавляются через ftruncate как разреженная область.
+// Файл сначала пишется рядом под временным именем, сбрасывается на диск и затем атомарно
+// заменяет path; после замены на диск сбрасывается и каталог
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+void SaveMapped(const std::string& path, const Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be mapped");
+
+    MappedVectorHeader header{};
+    std::memcpy(header.magic, MappedVectorHeader::kMagic, sizeof(header.magic));
+    header.version = MappedVectorHeader::kVersion;
+    header.endianness = MappedVectorHeader::kEndianness;
+    header.data_offset = detail::MappedDataOffset<T>();
+    header.size = v.Size();
+    header.capacity = v.Capacity();
+    header.elem_size = sizeof(T);
+    header.alignment = alignof(T);
+    header.fingerprint = TypeFingerprint<T>::Get();
+
+    const std::string temp_path = path + ".tmp";
+    const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        detail::ThrowSystemError("open " + temp_path);
+    }
+    try {
+        detail::WriteAll(fd, &header, sizeof(header), temp_path);
+        if (::lseek(fd, static_cast<off_t>(header.data_offset), SEEK_SET) < 0) {
+            detail::ThrowSystemError("lseek " + temp_path);
+        }
+        detail::WriteAll(fd, v.Data(), v.Size() * sizeof(T), temp_path);
+        const off_t length = static_cast<off_t>(header.data_offset + header.capacity * sizeof(T));
+        if (::ftruncate(fd, length) != 0) {
+            detail::ThrowSystemError("ftruncate " + temp_path);
+        }
+        // Данные должны попасть на диск до rename: иначе после сбоя под именем path может
+        // оказаться пустой или обрезанный файл
+        if (::fsync(fd) != 0) {
+            detail::ThrowSystemError("fsync " + temp_path);
+        }
+        if (::close(fd) != 0) {
+            detail::ThrowSystemError("close " + temp_path);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temp_path.c_str());
+        throw;
+    }
+    if (::rename(temp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        detail::ThrowSystemError("rename " + temp_path);
+    }
+    detail::SyncParentDirectory(path);
+}
+
+namespace detail {
+
+template <typename T>
+MappedVector<T> MapFile(const std::string& path, int prot) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be mapped");
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        detail::ThrowSystemError("open " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        detail::ThrowSystemError("fstat " + path);
+    }
+    const size_t length = static_cast<size_t>(st.st_size);
+    if (length < sizeof(MappedVectorHeader)) {
+        ::close(fd);
+        throw std::runtime_error(path + ": file is too short for a vector header");
+    }
+    void* base = ::mmap(nullptr, length, prot, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        errno = error;
+        detail::ThrowSystemError("mmap " + path);
+    }
+    auto region = std::make_shared<detail::MappedRegion>(base, length);
+
+    MappedVectorHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, MappedVectorHeader::kMagic, sizeof(header.magic)) != 0
+        || header.version != MappedVectorHeader::kVersion
+        || header.endianness != MappedVectorHeader::kEndianness) {
+        throw std::runtime_error(path + ": not a vector file of a supported version");
+    }
+    if (header.elem_size != sizeof(T) || header.alignment != alignof(T)
+        || header.fingerprint != TypeFingerprint<T>::Get()) {
+        throw std::runtime_error(path + ": file was written for a different element type");
+    }
+    if (header.data_offset % alignof(T) != 0 || header.data_offset > length
+        || header.size > header.capacity
+        || header.capacity > (length - header.data_offset) / sizeof(T)) {
+        throw std::runtime_error(path + ": header does not match the file size");
+    }
+
+    T* data = reinterpret_cast<T*>(static_cast<char*>(base) + header.data_offset);
+    RawMemory<T, MappedFileAllocator<T>> buffer(data, header.capacity, MappedFileAllocator<T>(std::move(region)));
+    return MappedVector<T>(std::move(buffer), header.size);
+}
+
+}  // namespace detail
+
+// Открывает вектор поверх отображения файла, сохранённого SaveMapped, без чтения
+// и копирования элементов. Выбрасывает std::system_error при ошибке ввода-вывода и
+// std::runtime_error, если файл повреждён или записан для другого типа элементов
+template <typename T>
+MappedView<T> OpenMapped(const std::string& path, MapMode::ReadOnlyT = MapMode::kReadOnly) {
+    return MappedView<T>(detail::MapFile<T>(path, PROT_READ));
+}
+
+template <typename T>
+MappedVector<T> OpenMapped(const std::string& path, MapMode::CopyOnWriteT) {
+    return detail::MapFile<T>(path, PROT_READ | PROT_WRITE);
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <utility>
+
+// Вектор с общим буфером для дешёвых снимков. Замороженный Vector лежит в блоке вместе
+// со счётчиком ссылок, поэтому копирование SharedVector стоит O(1) и не копирует элементы.
+// Изменение через Mutable отделяет копию буфера, только если им владеет кто-то ещё:
+// первая запись в общий буфер копирует элементы, последующие работают на месте.
+//
+// Копировать и читать разные SharedVector с общим буфером можно одновременно из разных
+// потоков. Mutable и Release меняют объект и требуют, чтобы к нему самому других
+// обращений не было. Владелец, отпуская блок, уменьшает счётчик с memory_order_acq_rel,
+// а Mutable и Release проверяют единоличное владение загрузкой с memory_order_acquire:
+// чтения прежних владельцев завершаются раньше, чем буфер изменяется или разрушается
+template <typename T, typename Alloc = std::allocator<T>>
+class SharedVector {
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using const_iterator = const T*;
+    using VectorType = Vector<T, Alloc>;
+
+    SharedVector() = default;
+
+    // Забирает буфер vector без копирования элементов
+    explicit SharedVector(VectorType&& vector)
+        : block_(MakeBlock(vector.GetAllocator(), std::move(vector))) {
+    }
+
+    SharedVector(const SharedVector& other) noexcept
+        : block_(other.block_) {
+        if (block_ != nullptr) {
+            // Новая ссылка получена из существующей, поэтому упорядочивать нечего
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedVector(SharedVector&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    SharedVector& operator=(const SharedVector& rhs) noexcept {
+        SharedVector(rhs).Swap(*this);
+        return *this;
+    }
+
+    SharedVector& operator=(SharedVector&& rhs) noexcept {
+        SharedVector(std::move(rhs)).Swap(*this);
+        return *this;
+    }
+
+    ~SharedVector() {
+        Unref(block_);
+    }
+
+    void Swap(SharedVector& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+    size_t Size() const noexcept {
+        return block_ != nullptr ? block_->vector.Size() : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return block_ != nullptr ? block_->vector.Capacity() : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return block_->vector[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return block_ != nullptr ? block_->vector.Data() : nullptr;
+    }
+    const_iterator end() const noexcept {
+        return block_ != nullptr ? block_->vector.Data() + block_->vector.Size() : nullptr;
+    }
+    const_iterator cbegin() const noexcept {
+        return this->begin();
+    }
+    const_iterator cend() const noexcept {
+        return this->end();
+    }
+
+    // Число SharedVector, разделяющих буфер. Если другие потоки копируют или отпускают
+    // буфер, значение может сразу устареть
+    size_t UseCount() const noexcept {
+        return block_ != nullptr ? block_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    bool IsShared() const noexcept {
+        return block_ != nullptr && block_->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    // Возвращает вектор для изменения, предварительно отделив собственную копию буфера,
+    // если он общий. Ссылка действительна до следующего копирования или присваивания
+    // этого SharedVector
+    VectorType& Mutable() {
+        if (block_ == nullptr) {
+            block_ = MakeBlock(Alloc());
+        } else if (IsShared()) {
+            Block* copy = MakeBlock(block_->vector.GetAllocator(), std::as_const(block_->vector));
+            Unref(std::exchange(block_, copy));
+        }
+        return block_->vector;
+    }
+
+    // Возвращает элементы в виде обычного Vector и опустошает SharedVector.
+    // Единственный владелец отдаёт буфер без копирования, иначе элементы копируются.
+    // Если копирование выбросило исключение, SharedVector не изменяется
+    VectorType Release() {
+        if (block_ == nullptr) {
+            return VectorType();
+        }
+        VectorType result = IsShared() ? VectorType(std::as_const(block_->vector))
+                                       : VectorType(std::move(block_->vector));
+        Unref(std::exchange(block_, nullptr));
+        return result;
+    }
+
+private:
+    // Счётчик ссылок и вектор в одном выделении памяти
+    struct Block {
+        template <typename... Args>
+        explicit Block(Args&&... args)
+            : vector(std::forward<Args>(args)...) {
+        }
+
+        std::atomic<size_t> refs{1};
+        VectorType vector;
+    };
+
+    using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+    using BlockTraits = std::allocator_traits<BlockAlloc>;
+
+    // Создаёт блок с единственной ссылкой, память под который выделяет alloc
+    template <typename... Args>
+    static Block* MakeBlock(const Alloc& alloc, Args&&... args) {
+        BlockAlloc block_alloc(alloc);
+        Block* block = BlockTraits::allocate(block_alloc, 1);
+        try {
+            BlockTraits::construct(block_alloc, block, std::forward<Args>(args)...);
+        } catch (...) {
+            BlockTraits::deallocate(block_alloc, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    // Последний владелец разрушает блок
+    static void Unref(Block* block) noexcept {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BlockAlloc block_alloc(block->vector.GetAllocator());
+            BlockTraits::destroy(block_alloc, block);
+            BlockTraits::deallocate(block_alloc, block, 1);
+        }
+    }
+
+    // Вектор изменяется только через Mutable, когда этот объект единолично владеет блоком
+    Block* block_ = nullptr;
+};
@@ -0,0 +1,228 @@
+#pragma once
+#include "vector.h"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Встроенный буфер SmallVector на N элементов и признак того, что он занят
+template <typename T, size_t N>
+struct InlineBuffer {
+    alignas(T) unsigned char storage[N * sizeof(T)];
+    bool in_use = false;
+
+    T* GetAddress() noexcept {
+        return reinterpret_cast<T*>(storage);
+    }
+
+    const T* GetAddress() const noexcept {
+        return reinterpret_cast<const T*>(storage);
+    }
+};
+
+// Политика роста SmallVector: встроенный буфер никогда не сжимается
+template <typename Growth, size_t N>
+struct InlineGrowth : Growth {
+    static size_t ShrinkCapacity(size_t capacity, size_t size, size_t elem_size) noexcept {
+        return capacity <= N ? capacity : Growth::ShrinkCapacity(capacity, size, elem_size);
+    }
+};
+
+template <typename Growth, size_t N>
+using SmallVectorGrowth
+    = std::conditional_t<kHasShrinkCapacity<Growth>, InlineGrowth<Growth, N>, Growth>;
+
+}  // namespace detail
+
+// Аллокатор SmallVector: отдаёт встроенный буфер, если он свободен и запрос в него помещается,
+// иначе обращается к Base. Буфер принадлежит конкретному вектору, поэтому аллокаторы разных
+// векторов не равны и не распространяются при присваивании и обмене
+template <typename T, size_t N, typename Base = std::allocator<T>>
+class InlineAllocator {
+    using BaseTraits = std::allocator_traits<Base>;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    explicit InlineAllocator(detail::InlineBuffer<T, N>* buffer, const Base& base = Base()) noexcept
+        : base_(base)
+        , buffer_(buffer) {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    // Встроенный буфер всегда отдаётся целиком, чтобы ёмкость вектора сразу стала равна N
+    auto allocate_at_least(size_t n) {
+        struct Result {
+            T* ptr;
+            size_t count;
+        };
+        if (n <= N && !buffer_->in_use) {
+            buffer_->in_use = true;
+            return Result{buffer_->GetAddress(), N};
+        }
+        return Result{BaseTraits::allocate(base_, n), n};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (p == buffer_->GetAddress()) {
+            buffer_->in_use = false;
+        } else {
+            BaseTraits::deallocate(base_, p, n);
+        }
+    }
+
+    bool IsInline(const T* p) const noexcept {
+        return p == buffer_->GetAddress();
+    }
+
+    const Base& GetBase() const noexcept {
+        return base_;
+    }
+
+    bool operator==(const InlineAllocator& other) const noexcept {
+        return buffer_ == other.buffer_;
+    }
+
+    bool operator!=(const InlineAllocator& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    [[no_unique_address]] Base base_;
+    detail::InlineBuffer<T, N>* buffer_;
+};
+
+// Вектор, хранящий до N элементов во встроенном буфере и переходящий в динамическую память
+// только при превышении N. Все операции выполняет Vector: встроенный буфер — это лишь
+// память, которую выдаёт InlineAllocator, поэтому семантика EmplaceBack/Emplace/Erase/Reserve
+// и гарантии безопасности исключений совпадают с Vector.
+// Перемещение и обмен забирают буфер в динамической памяти целиком и переносят элементы
+// поштучно, только если они лежат во встроенном буфере.
+// ReleaseBuffer и AdoptBuffer удалены, чтобы встроенный буфер не покидал объект.
+// SmallVector нельзя перемещать через ссылку на базовый Vector: тот забрал бы указатель
+// на чужой встроенный буфер
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SmallVector
+    : private detail::InlineBuffer<T, N>  // инициализируется раньше базового Vector
+    , public Vector<T, InlineAllocator<T, N, Alloc>, detail::SmallVectorGrowth<Growth, N>> {
+    static_assert(N > 0, "SmallVector needs a non-empty inline buffer");
+
+    using Buffer = detail::InlineBuffer<T, N>;
+    using Base = Vector<T, InlineAllocator<T, N, Alloc>, detail::SmallVectorGrowth<Growth, N>>;
+
+public:
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallVector()
+        : Base(MakeAllocator(static_cast<Buffer*>(this), Alloc())) {
+        this->Reserve(N);
+    }
+
+    explicit SmallVector(const Alloc& alloc)
+        : Base(MakeAllocator(static_cast<Buffer*>(this), alloc)) {
+        this->Reserve(N);
+    }
+
+    SmallVector(size_t size, const Alloc& alloc = Alloc())
+        : Base(size, MakeAllocator(static_cast<Buffer*>(this), alloc)) {
+        this->Reserve(N);
+    }
+
+    SmallVector(const SmallVector& other)
+        : Base(other, MakeAllocator(static_cast<Buffer*>(this),
+                                    std::allocator_traits<Alloc>::select_on_container_copy_construction(
+                                        other.GetAllocator().GetBase()))) {
+        this->Reserve(N);
+    }
+
+    // Буфер в динамической памяти забирается целиком, и other возвращается к встроенному буферу.
+    // Из встроенного буфера other элементы перемещаются поштучно
+    SmallVector(SmallVector&& other) noexcept(kNothrowMove)
+        : Base(MakeAllocator(static_cast<Buffer*>(this), other.GetAllocator().GetBase())) {
+        if (CanAdoptBuffer(other)) {
+            AdoptBufferOf(other);
+        } else {
+            Base temp(std::move(other), this->GetAllocator());
+            Base::Swap(temp);
+        }
+        this->Reserve(N);
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        Base::operator=(rhs);
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(kNothrowMove
+                                                       && std::is_nothrow_move_assignable_v<T>) {
+        if (CanAdoptBuffer(rhs)) {
+            AdoptBufferOf(rhs);
+        } else {
+            Base::operator=(std::move(rhs));
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) noexcept(kNothrowMove && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &other) {
+            SmallVector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+    }
+
+    // Элементы из динамической памяти возвращаются во встроенный буфер, если помещаются в него:
+    // Vector перевыделяет буфер под Size() элементов, и InlineAllocator отдаёт встроенный.
+    // Пустой вектор Vector освобождает без нового буфера, поэтому встроенный занимается явно
+    void ShrinkToFit() {
+        if (!IsInline()) {
+            Base::ShrinkToFit();
+            if (this->Capacity() == 0) {
+                this->Reserve(N);
+            }
+        }
+    }
+
+    // Буфер может оказаться встроенным: указатель на него не должен покидать объект,
+    // а чужой встроенный буфер нельзя принять во владение
+    VectorBuffer<T> ReleaseBuffer() = delete;
+    void AdoptBuffer(VectorBuffer<T> buffer) = delete;
+
+    // Элементы лежат во встроенном буфере
+    bool IsInline() const noexcept {
+        return this->GetAllocator().IsInline(this->Data());
+    }
+
+private:
+    // Перемещение не выделяет память: буфер в динамической памяти забирается,
+    // а встроенный буфер вмещает элементы встроенного буфера источника
+    static constexpr bool kNothrowMove
+        = std::is_nothrow_move_constructible_v<T> && std::allocator_traits<Alloc>::is_always_equal::value;
+
+    // Буфер other лежит в динамической памяти, и его может освободить аллокатор этого вектора
+    bool CanAdoptBuffer(const SmallVector& other) const noexcept {
+        return this != &other && other.Data() != nullptr && !other.IsInline()
+            && this->GetAllocator().GetBase() == other.GetAllocator().GetBase();
+    }
+
+    // Прежние элементы разрушаются, а other остаётся пустым во встроенном буфере
+    void AdoptBufferOf(SmallVector& other) noexcept {
+        Base::AdoptBuffer(other.Base::ReleaseBuffer());
+        other.Reserve(N);
+    }
+
+    // Вызывается из списка инициализации до построения Base, поэтому статическая
+    // и получает адрес уже построенного встроенного буфера
+    static InlineAllocator<T, N, Alloc> MakeAllocator(Buffer* buffer, const Alloc& alloc) noexcept {
+        return InlineAllocator<T, N, Alloc>(buffer, alloc);
+    }
+};
@@ -0,0 +1,633 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+template <typename T>
+struct IsTuple : std::false_type {};
+
+template <typename... Ts>
+struct IsTuple<std::tuple<Ts...>> : std::true_type {};
+
+}  // namespace detail
+
+// Поле I строки SoaVector. Принимает и прокси-ссылку, и value_type, поэтому подходит
+// для компараторов: алгоритмы std:: сравнивают ссылки и с сохранёнными значениями строк
+template <size_t I, typename Row>
+decltype(auto) GetField(Row&& row) noexcept {
+    if constexpr (detail::IsTuple<std::decay_t<Row>>::value) {
+        return std::get<I>(std::forward<Row>(row));
+    } else {
+        return row.template Get<I>();
+    }
+}
+
+// Непрерывный участок одного столбца SoaVector. Описывает data() и size(),
+// поэтому в C++20 приводится к std::span
+template <typename T>
+class ColumnSpan {
+public:
+    using value_type = std::remove_const_t<T>;
+    using iterator = T*;
+
+    ColumnSpan() = default;
+
+    ColumnSpan(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    T* data() const noexcept {
+        return data_;
+    }
+    size_t size() const noexcept {
+        return size_;
+    }
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    T* begin() const noexcept {
+        return data_;
+    }
+    T* end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Вектор записей из полей Fields..., хранящий каждое поле в отдельном буфере RawMemory
+// («структура массивов»). Цикл, читающий одно поле, проходит только по его столбцу,
+// не загружая в кеш остальные поля.
+//
+// Элемент доступен через прокси-ссылку reference: Get<I>() возвращает ссылку на поле I,
+// присваивание и swap меняют значения полей, а value_type — std::tuple<Fields...>.
+// Прокси всегда временный, поэтому присваивание прокси и приведение к value_type копируют
+// поля: перемещение выполняют только MoveOut, iter_move и присваивание value_type&&.
+// Итераторы произвольного доступа, поэтому строки можно обрабатывать алгоритмами std::,
+// например сортировать. Column<I>() даёт столбец целиком для векторизованных циклов.
+//
+// Все столбцы растут вместе и имеют общую ёмкость. При перевыделении сначала строятся
+// столбцы, перенос которых может выбросить исключение, и лишь затем переносятся остальные,
+// поэтому рост даёт строгую гарантию, как и у Vector. Поле, которое нельзя скопировать
+// и перемещение которого не noexcept, при росте перемещается в первом проходе: если рост
+// прервало исключение, вектор сохраняет размер, но поля этого столбца могут остаться
+// в перемещённом состоянии, то есть гарантия только базовая
+template <typename... Fields>
+class SoaVector {
+    static_assert(sizeof...(Fields) > 0, "SoaVector needs at least one field");
+
+    static constexpr size_t kFieldCount = sizeof...(Fields);
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+    using Indices = std::make_index_sequence<kFieldCount>;
+
+public:
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using value_type = std::tuple<Fields...>;
+
+    template <bool IsConst>
+    class Reference {
+        template <typename T>
+        using Ref = std::conditional_t<IsConst, const T&, T&>;
+
+    public:
+        explicit Reference(Ref<Fields>... fields) noexcept
+            : fields_(fields...) {
+        }
+
+        Reference(const Reference&) = default;
+
+        // Ссылка на изменяемую строку приводится к константной
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Reference(const Reference<OtherConst>& other) noexcept
+            : fields_(other.fields_) {
+        }
+
+        // Присваивание меняет значения полей, а не то, на что ссылается прокси
+        Reference& operator=(const Reference& other) {
+            AssignFrom(other.fields_, Indices{});
+            return *this;
+        }
+
+        Reference& operator=(const value_type& value) {
+            AssignFrom(value, Indices{});
+            return *this;
+        }
+
+        Reference& operator=(value_type&& value) {
+            MoveFrom(value, Indices{});
+            return *this;
+        }
+
+        template <size_t I>
+        Ref<Field<I>> Get() const noexcept {
+            return std::get<I>(fields_);
+        }
+
+        operator value_type() const& {
+            return std::make_from_tuple<value_type>(fields_);
+        }
+
+        // Отдаёт значения полей перемещением, оставляя поля строки в перемещённом состоянии
+        value_type MoveOut() const {
+            static_assert(!IsConst, "cannot move out of a const reference");
+            return std::apply([](auto&... fields) {
+                return value_type(std::move(fields)...);
+            }, fields_);
+        }
+
+        friend void swap(Reference lhs, Reference rhs) {
+            static_assert(!IsConst, "cannot swap through a const reference");
+            SwapFields(lhs, rhs, Indices{});
+        }
+
+        friend bool operator==(const Reference& lhs, const Reference& rhs) {
+            return lhs.fields_ == rhs.fields_;
+        }
+        friend bool operator==(const Reference& lhs, const value_type& rhs) {
+            return lhs.fields_ == rhs;
+        }
+        friend bool operator==(const value_type& lhs, const Reference& rhs) {
+            return lhs == rhs.fields_;
+        }
+        friend bool operator!=(const Reference& lhs, const Reference& rhs) {
+            return !(lhs == rhs);
+        }
+        friend bool operator!=(const Reference& lhs, const value_type& rhs) {
+            return !(lhs == rhs);
+        }
+        friend bool operator!=(const value_type& lhs, const Reference& rhs) {
+            return !(lhs == rhs);
+        }
+
+        // Лексикографическое сравнение по полям, как у std::tuple
+        friend bool operator<(const Reference& lhs, const Reference& rhs) {
+            return lhs.fields_ < rhs.fields_;
+        }
+        friend bool operator<(const Reference& lhs, const value_type& rhs) {
+            return lhs.fields_ < rhs;
+        }
+        friend bool operator<(const value_type& lhs, const Reference& rhs) {
+            return lhs < rhs.fields_;
+        }
+
+    private:
+        friend class Reference<!IsConst>;
+
+        template <typename Tuple, size_t... I>
+        void AssignFrom(const Tuple& source, std::index_sequence<I...>) {
+            static_assert(!IsConst, "cannot assign through a const reference");
+            ((std::get<I>(fields_) = std::get<I>(source)), ...);
+        }
+
+        template <typename Tuple, size_t... I>
+        void MoveFrom(Tuple& source, std::index_sequence<I...>) {
+            static_assert(!IsConst, "cannot assign through a const reference");
+            ((std::get<I>(fields_) = std::move(std::get<I>(source))), ...);
+        }
+
+        template <size_t... I>
+        static void SwapFields(Reference& lhs, Reference& rhs, std::index_sequence<I...>) {
+            using std::swap;
+            (swap(std::get<I>(lhs.fields_), std::get<I>(rhs.fields_)), ...);
+        }
+
+        std::tuple<Ref<Fields>...> fields_;
+    };
+
+    template <bool IsConst>
+    class Iterator {
+        using Container = std::conditional_t<IsConst, const SoaVector, SoaVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Reference<IsConst>;
+
+        Iterator() = default;
+
+        Iterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*container_)[index_];
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return (*container_)[index_ + n];
+        }
+
+        // Перемещение строки, которое находят ranges::iter_move и алгоритмы C++20
+        friend value_type iter_move(const Iterator& it) {
+            return (*it).MoveOut();
+        }
+
+        // Номер строки, на которую указывает итератор
+        size_t Index() const noexcept {
+            return index_;
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class Iterator<!IsConst>;
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using reference = Reference<false>;
+    using const_reference = Reference<true>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    SoaVector() = default;
+
+    // Конструкторы делегируют пустому вектору, чтобы при исключении деструктор
+    // разрушил уже построенные строки
+    explicit SoaVector(size_t size)
+        : SoaVector() {
+        Resize(size);
+    }
+
+    SoaVector(const SoaVector& other)
+        : SoaVector() {
+        Reserve(other.size_);
+        for (size_t index = 0; index < other.size_; ++index) {
+            ConstructRow(columns_, size_, other.RowFields(index, Indices{}));
+            ++size_;
+        }
+    }
+
+    SoaVector(SoaVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    SoaVector& operator=(const SoaVector& rhs) {
+        if (this != &rhs) {
+            SoaVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SoaVector moved(std::move(rhs));
+            Swap(moved);
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        DestroyRows(columns_, 0, size_);
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        columns_.swap(other.columns_);
+        std::swap(size_, other.size_);
+    }
+
+    // Добавляет строку, строя каждое поле из соответствующего аргумента
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == kFieldCount, "EmplaceBack takes one argument per field");
+        if (size_ == Capacity()) {
+            // Строка строится в новых буферах до переноса, поэтому аргументы могут
+            // ссылаться на элементы самого вектора
+            Columns buffers = AllocateColumns(Growth::NextCapacity(Capacity(), size_ + 1, kRowSize));
+            ConstructRow(buffers, size_, std::forward_as_tuple(std::forward<Args>(args)...));
+            try {
+                RelocateColumns(buffers);
+            } catch (...) {
+                DestroyRows(buffers, size_, size_ + 1);
+                throw;
+            }
+            columns_.swap(buffers);
+        } else {
+            ConstructRow(columns_, size_, std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const value_type& value) {
+        std::apply([this](const Fields&... fields) {
+            EmplaceBack(fields...);
+        }, value);
+    }
+
+    void PushBack(value_type&& value) {
+        std::apply([this](Fields&... fields) {
+            EmplaceBack(std::move(fields)...);
+        }, value);
+    }
+
+    void PopBack() noexcept {
+        if (size_ > 0) {
+            DestroyRows(columns_, size_ - 1, size_);
+            --size_;
+        }
+    }
+
+    // Новые строки инициализируются значением. Если построение строки выбросило
+    // исключение, вектор сохраняет прежний размер
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyRows(columns_, new_size, size_);
+            size_ = new_size;
+            return;
+        }
+        Reserve(new_size);
+        size_t index = size_;
+        try {
+            for (; index < new_size; ++index) {
+                ConstructRow(columns_, index, std::tuple<>());
+            }
+        } catch (...) {
+            DestroyRows(columns_, size_, index);
+            throw;
+        }
+        size_ = new_size;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        Columns buffers = AllocateColumns(new_capacity);
+        RelocateColumns(buffers);
+        columns_.swap(buffers);
+    }
+
+    void Clear() noexcept {
+        DestroyRows(columns_, 0, size_);
+        size_ = 0;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    // Столбец поля I из Size() элементов. Указатели действительны до перевыделения
+    template <size_t I>
+    ColumnSpan<Field<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    ColumnSpan<const Field<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return MakeReference<reference>(*this, index, Indices{});
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return MakeReference<const_reference>(*this, index, Indices{});
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+    const_iterator cbegin() const noexcept {
+        return this->begin();
+    }
+    const_iterator cend() const noexcept {
+        return this->end();
+    }
+
+private:
+    using Growth = DoublingGrowth;
+
+    // Перенос элементов столбца при перевыделении может выбросить исключение
+    template <typename T>
+    static constexpr bool kThrowsOnRelocate
+        = !kIsTriviallyRelocatable<T> && !std::is_nothrow_move_constructible_v<T>;
+
+    // Такие столбцы при перевыделении копируются, если это возможно
+    template <typename T>
+    static constexpr bool kCopiedOnRelocate = kThrowsOnRelocate<T> && std::is_copy_constructible_v<T>;
+
+    static Columns AllocateColumns(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    template <typename Ref, typename Self, size_t... I>
+    static Ref MakeReference(Self& self, size_t index, std::index_sequence<I...>) noexcept {
+        return Ref(std::get<I>(self.columns_).GetAddress()[index]...);
+    }
+
+    template <size_t... I>
+    std::tuple<const Fields&...> RowFields(size_t index, std::index_sequence<I...>) const noexcept {
+        return std::tuple<const Fields&...>(std::get<I>(columns_).GetAddress()[index]...);
+    }
+
+    // Строит поля строки index в columns из элементов кортежа args, а при пустом кортеже
+    // инициализирует их значением. Если поле выбросило исключение, уже построенные разрушаются
+    template <size_t I = 0, typename Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&& args) {
+        if constexpr (I < kFieldCount) {
+            Field<I>* slot = std::get<I>(columns).GetAddress() + index;
+            if constexpr (std::tuple_size_v<std::remove_reference_t<Args>> == 0) {
+                new (slot) Field<I>();
+            } else {
+                new (slot) Field<I>(std::get<I>(std::move(args)));
+            }
+            try {
+                ConstructRow<I + 1>(columns, index, std::forward<Args>(args));
+            } catch (...) {
+                std::destroy_at(slot);
+                throw;
+            }
+        }
+    }
+
+    static void DestroyRows(Columns& columns, size_t first, size_t last) noexcept {
+        std::apply([first, last](auto&... column) {
+            (std::destroy(column.GetAddress() + first, column.GetAddress() + last), ...);
+        }, columns);
+    }
+
+    // Переносит строки во вновь выделенные столбцы buffers. Исходные столбцы остаются
+    // без живых элементов. При исключении buffers не содержат живых элементов, а исходные
+    // столбцы не меняются, кроме перемещённых столбцов без копирования (см. kThrowsOnRelocate)
+    void RelocateColumns(Columns& buffers) {
+        BuildThrowingColumns(buffers);
+        MoveColumns(buffers, Indices{});
+    }
+
+    // Первый проход: строит в buffers столбцы, перенос которых может выбросить исключение,
+    // не разрушая исходные элементы. При исключении построенные столбцы разрушаются
+    template <size_t I = 0>
+    void BuildThrowingColumns(Columns& buffers) {
+        if constexpr (I < kFieldCount) {
+            if constexpr (kThrowsOnRelocate<Field<I>>) {
+                Field<I>* source = std::get<I>(columns_).GetAddress();
+                Field<I>* dest = std::get<I>(buffers).GetAddress();
+                if constexpr (kCopiedOnRelocate<Field<I>>) {
+                    std::uninitialized_copy_n(source, size_, dest);
+                } else {
+                    std::uninitialized_move_n(source, size_, dest);
+                }
+                try {
+                    BuildThrowingColumns<I + 1>(buffers);
+                } catch (...) {
+                    std::destroy_n(dest, size_);
+                    throw;
+                }
+            } else {
+                BuildThrowingColumns<I + 1>(buffers);
+            }
+        }
+    }
+
+    // Второй проход не выбрасывает исключений: переносит остальные столбцы
+    // и разрушает исходные элементы
+    template <size_t... I>
+    void MoveColumns(Columns& buffers, std::index_sequence<I...>) noexcept {
+        (MoveColumn<I>(buffers), ...);
+    }
+
+    template <size_t I>
+    void MoveColumn(Columns& buffers) noexcept {
+        using T = Field<I>;
+        T* source = std::get<I>(columns_).GetAddress();
+        T* dest = std::get<I>(buffers).GetAddress();
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            if (size_ != 0) {
+                std::memcpy(static_cast<void*>(dest), source, size_ * sizeof(T));
+            }
+            return;
+        } else if constexpr (!kThrowsOnRelocate<T>) {
+            std::uninitialized_move_n(source, size_, dest);
+        }
+        std::destroy_n(source, size_);
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
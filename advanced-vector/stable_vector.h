@@ -0,0 +1,327 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Размер блока по умолчанию: около 16 КиБ, округлённых вниз до степени двойки элементов
+template <typename T>
+constexpr size_t DefaultStableBlockSize() noexcept {
+    size_t size = 1;
+    while (size * 2 * sizeof(T) <= 16 * 1024) {
+        size *= 2;
+    }
+    return size;
+}
+
+}  // namespace detail
+
+// Вектор из блоков RawMemory по BlockSize элементов. Рост добавляет новый блок и никогда
+// не перемещает существующие элементы, поэтому:
+//   * EmplaceBack стоит O(1) без амортизации, а пиковая память при росте не удваивается;
+//   * ссылки, указатели и итераторы на элементы остаются действительными до их удаления;
+//   * элементы не обязаны уметь перемещаться или копироваться.
+// Элементы не лежат в памяти подряд: operator[] выполняет одно дополнительное разыменование
+template <typename T, typename Alloc = std::allocator<T>
+          , size_t BlockSize = detail::DefaultStableBlockSize<T>()>
+class StableVector {
+    static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0,
+                  "BlockSize must be a power of two");
+
+    using Block = RawMemory<T, Alloc>;
+
+    template <bool IsConst>
+    class Iterator {
+        using Container = std::conditional_t<IsConst, const StableVector, StableVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        Iterator() = default;
+
+        Iterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*container_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*container_)[index_];
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return (*container_)[index_ + n];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class Iterator<!IsConst>;
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    static constexpr size_t kBlockSize = BlockSize;
+
+    StableVector() = default;
+
+    explicit StableVector(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Конструкторы делегируют пустому вектору, чтобы при исключении деструктор
+    // разрушил уже построенные элементы
+    StableVector(size_t size, const Alloc& alloc = Alloc())
+        : StableVector(alloc) {
+        Resize(size);
+    }
+
+    StableVector(const StableVector& other)
+        : StableVector(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_)) {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    StableVector(StableVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , blocks_(std::move(other.blocks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    StableVector& operator=(const StableVector& rhs) {
+        if (this != &rhs) {
+            StableVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    StableVector& operator=(StableVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            alloc_ = rhs.alloc_;
+            blocks_ = std::move(rhs.blocks_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~StableVector() {
+        Clear();
+    }
+
+    void Swap(StableVector& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        blocks_.Swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            blocks_.EmplaceBack(BlockSize, alloc_);
+        }
+        T* slot = Slot(size_);
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        if (size_ > 0) {
+            Slot(size_ - 1)->~T();
+            --size_;
+        }
+    }
+
+    void Resize(size_t new_size) {
+        while (size_ > new_size) {
+            PopBack();
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    // Выделяет блоки, вмещающие new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        const size_t blocks = (new_capacity + BlockSize - 1) / BlockSize;
+        blocks_.Reserve(blocks);
+        while (blocks_.Size() < blocks) {
+            blocks_.EmplaceBack(BlockSize, alloc_);
+        }
+    }
+
+    void Clear() noexcept {
+        while (size_ > 0) {
+            PopBack();
+        }
+    }
+
+    // Освобождает блоки, в которых не осталось элементов
+    void ShrinkToFit() {
+        const size_t used = (size_ + BlockSize - 1) / BlockSize;
+        while (blocks_.Size() > used) {
+            blocks_.PopBack();
+        }
+        blocks_.ShrinkToFit();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return blocks_.Size() * BlockSize;
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StableVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+    const_iterator cbegin() const noexcept {
+        return this->begin();
+    }
+    const_iterator cend() const noexcept {
+        return this->end();
+    }
+
+private:
+    T* Slot(size_t index) noexcept {
+        return blocks_[index / BlockSize].GetAddress() + index % BlockSize;
+    }
+
+    [[no_unique_address]] Alloc alloc_;
+    Vector<Block> blocks_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <thread>
+
+// Исполнитель параллельных операций Vector, запускающий задачи на новых потоках при каждом
+// вызове Run. Подходит для редких массовых операций над большими векторами; частые вызовы
+// выгоднее передавать исполнителю поверх собственного пула потоков с тем же интерфейсом
+class ThreadExecutor {
+public:
+    explicit ThreadExecutor(size_t concurrency = std::max(1u, std::thread::hardware_concurrency())) noexcept
+        : concurrency_(std::max<size_t>(concurrency, 1)) {
+    }
+
+    size_t Concurrency() const noexcept {
+        return concurrency_;
+    }
+
+    // Задача 0 выполняется в вызывающем потоке. Если поток запустить не удалось,
+    // его задача тоже выполняется в вызывающем потоке
+    template <typename F>
+    void Run(size_t count, const F& task) const noexcept {
+        Vector<std::thread> threads;
+        try {
+            threads.Reserve(count);
+        } catch (...) {
+        }
+        for (size_t i = 1; i < count; ++i) {
+            try {
+                threads.EmplaceBack([&task, i] {
+                    task(i);
+                });
+            } catch (...) {
+                task(i);
+            }
+        }
+        if (count > 0) {
+            task(0);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    size_t concurrency_;
+};
@@ -1,219 +1,1487 @@
 #pragma once
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <new>
 #include <utility>
 #include <stdexcept>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
 
+// Начиная с C++20 основные операции Vector доступны при константном вычислении: память
+// берётся через std::allocator_traits, а элементы строятся std::construct_at, так что таблицы
+// можно заполнять вектором во время компиляции и копировать в std::array
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated)
+#define VECTOR_HAS_CONSTEXPR 1
+#define VECTOR_CONSTEXPR constexpr
+#else
+#define VECTOR_CONSTEXPR
+#endif
+
+// Перевыделения буфера видны как USDT-проба advanced_vector:reallocate, к которой можно
+// подключиться bpftrace без пересборки программы. Неподключённая проба — одна инструкция nop.
+// Аргументы пробы — поля ReallocationEvent по порядку, например гистограмма времени переноса:
+//     bpftrace -e 'usdt:./app:advanced_vector:reallocate { @ns = hist(arg4); }'
+// VECTOR_NO_USDT отключает пробы
+#if !defined(VECTOR_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define VECTOR_HAS_USDT 1
+#endif
+#endif
+
+// Режим проверок для отладочных и staging-сборок. Макросы задаются до включения заголовка,
+// одинаково во всех единицах трансляции:
+//   VECTOR_BOUNDS_CHECK — проверка индексов и позиций: 0 — без проверок; 1 — assert
+//       (по умолчанию, выключается NDEBUG); 2 — проверки остаются и с NDEBUG, нарушение
+//       печатает условие и вызывает std::abort
+//   VECTOR_CHECK_ITERATORS — итераторы становятся классами, которые помнят поколение буфера:
+//       разыменование итератора после перевыделения, обмена или перемещения вектора
+//       либо за пределами [begin(), end()) завершает программу
+//   VECTOR_SANITIZE_CAPACITY — в сборке с AddressSanitizer запас ёмкости [Size(), Capacity())
+//       отмечается недоступным, и обращение к нему — ошибка container-overflow
+//   VECTOR_CHECKED — включает всё перечисленное, VECTOR_BOUNDS_CHECK по умолчанию равен 2
+#ifdef VECTOR_CHECKED
+#ifndef VECTOR_BOUNDS_CHECK
+#define VECTOR_BOUNDS_CHECK 2
+#endif
+#ifndef VECTOR_CHECK_ITERATORS
+#define VECTOR_CHECK_ITERATORS 1
+#endif
+#ifndef VECTOR_SANITIZE_CAPACITY
+#define VECTOR_SANITIZE_CAPACITY 1
+#endif
+#endif
+
+#ifndef VECTOR_BOUNDS_CHECK
+#define VECTOR_BOUNDS_CHECK 1
+#endif
+
+#if VECTOR_BOUNDS_CHECK == 0
+#define VECTOR_ASSERT(condition) static_cast<void>(0)
+#elif VECTOR_BOUNDS_CHECK == 1
+#define VECTOR_ASSERT(condition) assert(condition)
+#else
+#define VECTOR_ASSERT(condition) \
+    ((condition) ? static_cast<void>(0) : ::detail::CheckFailed(#condition, __FILE__, __LINE__))
+#endif
+
+#ifdef VECTOR_SANITIZE_CAPACITY
+#if defined(__SANITIZE_ADDRESS__)
+#define VECTOR_HAS_ASAN_ANNOTATIONS 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define VECTOR_HAS_ASAN_ANNOTATIONS 1
+#endif
+#endif
+#endif
+
+#ifdef VECTOR_HAS_ASAN_ANNOTATIONS
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+#if defined(VECTOR_CHECK_ITERATORS) || defined(VECTOR_HAS_ASAN_ANNOTATIONS)
+#define VECTOR_HAS_CHECK_SCOPE 1
+#endif
+
+// Тип тривиально перемещаем (trivially relocatable), если объект можно перенести
+// в другую область памяти побайтовым копированием, не вызывая ни конструктор перемещения,
+// ни деструктор исходного объекта. Для таких типов вектор перемещает элементы через memcpy/memmove.
+// Пользовательский тип заявляет это свойство специализацией шаблона:
+//     template <> struct IsTriviallyRelocatable<MyType> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+namespace detail {
+
+// Необязательные расширения аллокатора, которые использует RawMemory:
+//   bool try_expand(T* p, size_t old_n, size_t new_n) — увеличить буфер на месте;
+//   T* reallocate(T* p, size_t old_n, size_t new_n) — перевыделить буфер с побайтовым
+//                                                     переносом (nullptr при неудаче)
+template <typename Alloc, typename = void>
+struct HasTryExpand : std::false_type {};
+
+template <typename Alloc>
+struct HasTryExpand<Alloc, std::void_t<decltype(std::declval<Alloc&>().try_expand(
+    std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// auto allocate_at_least(size_t n) — выделить не менее n элементов, вернув {ptr, count},
+//                                     как std::allocator::allocate_at_least из C++23
+template <typename Alloc, typename = void>
+struct HasAllocateAtLeast : std::false_type {};
+
+template <typename Alloc>
+struct HasAllocateAtLeast<Alloc, std::void_t<decltype(std::declval<Alloc&>().allocate_at_least(
+    size_t{}))>> : std::true_type {};
+
+template <typename Alloc>
+inline constexpr bool kHasAllocateAtLeast = HasAllocateAtLeast<Alloc>::value;
+
+template <typename Alloc>
+inline constexpr bool kHasTryExpand = HasTryExpand<Alloc>::value;
+
+template <typename Alloc>
+inline constexpr bool kHasReallocate = HasReallocate<Alloc>::value;
+
+// static constexpr size_t kAlignment — выравнивание, которое аллокатор гарантирует для буферов
+template <typename Alloc, typename = void>
+struct AllocatorAlignment : std::integral_constant<size_t, alignof(typename Alloc::value_type)> {};
+
+template <typename Alloc>
+struct AllocatorAlignment<Alloc, std::void_t<decltype(Alloc::kAlignment)>>
+    : std::integral_constant<size_t, std::max(Alloc::kAlignment, alignof(typename Alloc::value_type))> {};
+
+// Политика роста может разрешить вектору отдавать память:
+//     static constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t elem_size) noexcept;
+// возвращает ёмкость не меньше size, до которой стоит уменьшить буфер, или capacity
+template <typename Growth, typename = void>
+struct HasShrinkCapacity : std::false_type {};
+
+template <typename Growth>
+struct HasShrinkCapacity<Growth, std::void_t<decltype(Growth::ShrinkCapacity(
+    size_t{}, size_t{}, size_t{}))>> : std::true_type {};
+
+template <typename Growth>
+inline constexpr bool kHasShrinkCapacity = HasShrinkCapacity<Growth>::value;
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+template <typename It, typename = void>
+struct IsInputIterator : std::false_type {};
+
+template <typename It>
+struct IsInputIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::input_iterator_tag> {};
+
+// Ограничение для перегрузок, принимающих диапазон [first, last)
+template <typename It>
+using RequireInputIterator = std::enable_if_t<IsInputIterator<It>::value>;
+
+template <typename It>
+inline constexpr bool kIsForwardIterator
+    = std::is_convertible_v<IteratorCategory<It>, std::forward_iterator_tag>;
+
+// Прямой итератор, count раз повторяющий одно и то же значение
+template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    RepeatIterator(const T* value, size_t index) noexcept
+        : value_(value)
+        , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return *value_;
+    }
+
+    RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    RepeatIterator operator++(int) noexcept {
+        RepeatIterator copy(*this);
+        ++index_;
+        return copy;
+    }
+
+    bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+
+    bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+private:
+    const T* value_;
+    size_t index_;
+};
+
+constexpr size_t SaturatingMul(size_t a, size_t b) noexcept {
+    return b != 0 && a > SIZE_MAX / b ? SIZE_MAX : a * b;
+}
+
+// Исполнитель параллельных операций Vector:
+//     size_t Concurrency() const;  — сколько задач имеет смысл выполнять одновременно
+//     template <typename F>
+//     void Run(size_t count, F task);  — вызывает task(i) для всех i из [0, count)
+//                                       и возвращается, когда все вызовы завершились
+// Задачи, которые передаёт Vector, не выбрасывают исключений
+template <typename Executor, typename = void>
+struct IsExecutor : std::false_type {};
+
+template <typename Executor>
+struct IsExecutor<Executor, std::void_t<decltype(std::declval<const Executor&>().Concurrency())>>
+    : std::true_type {};
+
+template <typename Executor>
+using RequireExecutor = std::enable_if_t<IsExecutor<Executor>::value>;
+
+// Минимальный объём данных на одну параллельную задачу: меньшие части не окупают запуск
+inline constexpr size_t kParallelGrainBytes = 256 * 1024;
+
+// Начало части chunk из chunks равных частей диапазона [0, n)
+inline size_t ChunkBegin(size_t n, size_t chunks, size_t chunk) noexcept {
+    return n / chunks * chunk + std::min(chunk, n % chunks);
+}
+
+constexpr bool IsConstantEvaluated() noexcept {
+#ifdef VECTOR_HAS_CONSTEXPR
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+// Нарушение проверки в режиме VECTOR_BOUNDS_CHECK == 2 или проверки итератора
+[[noreturn]] inline void CheckFailed(const char* condition, const char* file, int line) noexcept {
+    std::fprintf(stderr, "%s:%d: vector check failed: %s\n", file, line, condition);
+    std::abort();
+}
+
+// Переносит для AddressSanitizer границу доступной части буфера на capacity элементов
+// с old_mid на new_mid: ячейки до границы доступны, после неё — нет. Размечаются только
+// ячейки между old_mid и new_mid. Буфер с невыровненным началом не размечается, а неполная
+// последняя 8-байтовая гранула всегда остаётся доступной: её могут делить соседние объекты
+template <typename T>
+VECTOR_CONSTEXPR void AnnotateCapacity(const T* buffer, size_t capacity, size_t old_mid, size_t new_mid) noexcept {
+#ifdef VECTOR_HAS_ASAN_ANNOTATIONS
+    if (IsConstantEvaluated() || buffer == nullptr || old_mid == new_mid) {
+        return;
+    }
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(buffer);
+    const uintptr_t end = (begin + capacity * sizeof(T)) & ~uintptr_t{7};
+    const uintptr_t old_end = std::min(begin + old_mid * sizeof(T), end);
+    const uintptr_t new_end = std::min(begin + new_mid * sizeof(T), end);
+    if (begin % 8 != 0 || begin >= end || old_end == new_end) {
+        return;
+    }
+    __sanitizer_annotate_contiguous_container(reinterpret_cast<const void*>(begin), reinterpret_cast<const void*>(end)
+                                              , reinterpret_cast<const void*>(old_end)
+                                              , reinterpret_cast<const void*>(new_end));
+#else
+    static_cast<void>(buffer);
+    static_cast<void>(capacity);
+    static_cast<void>(old_mid);
+    static_cast<void>(new_mid);
+#endif
+}
+
+// Состояние проверок вектора: поколение буфера, которое запоминают итераторы,
+// и глубина вложенности изменяющих операций
+struct VectorChecks {
+    size_t generation = 0;
+    size_t depth = 0;
+};
+
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR T* ConstructAt(T* p, Args&&... args) {
+#ifdef VECTOR_HAS_CONSTEXPR
+    return std::construct_at(p, std::forward<Args>(args)...);
+#else
+    return new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Алгоритмы std::uninitialized_* недоступны при константном вычислении, там элементы
+// строятся по одному. Исключение всё равно прерывает константное вычисление, поэтому
+// откатывать построенные элементы не нужно
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedValueConstructN(T* first, size_t n) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(first + i);
+        }
+    } else {
+        std::uninitialized_value_construct_n(first, n);
+    }
+}
+
+template <typename InputIt, typename T>
+VECTOR_CONSTEXPR void UninitializedCopyN(InputIt first, size_t n, T* dest) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i, ++first) {
+            ConstructAt(dest + i, *first);
+        }
+    } else {
+        std::uninitialized_copy_n(first, n, dest);
+    }
+}
+
 template <typename T>
+VECTOR_CONSTEXPR void UninitializedMoveN(T* first, size_t n, T* dest) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(dest + i, std::move(first[i]));
+        }
+    } else {
+        std::uninitialized_move_n(first, n, dest);
+    }
+}
+
+// kForceMove — присваивать перемещением, даже если оно может выбросить исключение
+template <typename T, bool kForceMove = false>
+inline constexpr bool kMoveAssign = kForceMove || std::is_nothrow_move_assignable_v<T>
+                                    || !std::is_copy_assignable_v<T>;
+
+// Сдвигает [first, last) в живые объекты, начиная с dest, перемещающим присваиванием,
+// или копирующим, если перемещение может выбросить исключение
+template <bool kForceMove = false, typename T>
+void MoveAssignOrCopy(T* first, T* last, T* dest) {
+    if constexpr (kMoveAssign<T, kForceMove>) {
+        std::move(first, last, dest);
+    } else {
+        std::copy(first, last, dest);
+    }
+}
+
+// Аргумент присваивания по тому же правилу, что и в MoveAssignOrCopy
+template <bool kForceMove = false, typename T>
+decltype(auto) MoveAssignSource(T& value) noexcept {
+    if constexpr (kMoveAssign<T, kForceMove>) {
+        return std::move(value);
+    } else {
+        return std::as_const(value);
+    }
+}
+
+// Побайтово переносит n тривиально перемещаемых объектов; исходные объекты не разрушаются.
+// При константном вычислении побайтовый перенос запрещён, поэтому объекты перемещаются
+// и разрушаются обычным образом
+template <typename T>
+VECTOR_CONSTEXPR void Relocate(T* src, size_t n, T* dest) noexcept {
+    static_assert(kIsTriviallyRelocatable<T>);
+    if (IsConstantEvaluated()) {
+        UninitializedMoveN(src, n, dest);
+        std::destroy_n(src, n);
+    } else if (n != 0) {
+        std::memcpy(static_cast<void*>(dest), src, n * sizeof(T));
+    }
+}
+
+}  // namespace detail
+
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Alloc::value_type must match T");
+
 public:
+    using allocator_type = Alloc;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    VECTOR_CONSTEXPR explicit RawMemory(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Аллокатор может выделить больше запрошенного (allocate_at_least),
+    // тогда Capacity() отражает фактический размер блока
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : alloc_(alloc) {
+        buffer_ = Allocate(capacity);
+        capacity_ = capacity;
+    }
+
+    // Принимает во владение буфер на capacity элементов, который освободит alloc
+    VECTOR_CONSTEXPR RawMemory(T* buffer, size_t capacity, const Alloc& alloc) noexcept
+        : alloc_(alloc)
+        , buffer_(buffer)
         , capacity_(capacity) {
     }
 
     RawMemory(const RawMemory& other) = delete;
-    RawMemory(RawMemory&& other) {
-        this->Swap(other);
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
     }
 
     RawMemory& operator=(const RawMemory& rhs) = delete;
-    RawMemory& operator=(RawMemory&& rhs) {
+    // Если аллокатор распространяется при перемещении, память забирается вместе с ним,
+    // иначе аллокаторы должны быть равны, и буферы просто обмениваются
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                Deallocate(buffer_);
+                buffer_ = nullptr;
+                capacity_ = 0;
+                alloc_ = std::move(rhs.alloc_);
+            }
             this->Swap(rhs);
         }
         return *this;
     }
 
-    ~RawMemory() {
+    VECTOR_CONSTEXPR ~RawMemory() {
         Deallocate(buffer_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
-        assert(offset <= capacity_);
+        VECTOR_ASSERT(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < capacity_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_ASSERT(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    VECTOR_CONSTEXPR T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    VECTOR_CONSTEXPR size_t Capacity() const {
         return capacity_;
     }
 
+    VECTOR_CONSTEXPR const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Аллокатор умеет переносить буфер целиком (как realloc)
+    static constexpr bool kCanReallocate = detail::kHasReallocate<Alloc>;
+
+    // Пытается увеличить буфер до new_capacity на месте, не перемещая элементы.
+    // Возвращает false, если аллокатор этого не поддерживает или соседняя память занята
+    VECTOR_CONSTEXPR bool TryExpand(size_t new_capacity) noexcept {
+        if constexpr (detail::kHasTryExpand<Alloc>) {
+            if (buffer_ != nullptr && alloc_.try_expand(buffer_, capacity_, new_capacity)) {
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Отказывается от владения буфером и возвращает его. Освободить буфер должен
+    // вызывающий код тем же аллокатором
+    VECTOR_CONSTEXPR T* Release() noexcept {
+        detail::AnnotateCapacity(buffer_, capacity_, 0, capacity_);
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    // Перевыделяет буфер средствами аллокатора, побайтово перенося его содержимое.
+    // Допустимо только для тривиально перемещаемых T
+    void Reallocate(size_t new_capacity) {
+        static_assert(kCanReallocate && kIsTriviallyRelocatable<T>);
+        if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+        } else {
+            detail::AnnotateCapacity(buffer_, capacity_, 0, capacity_);
+            T* buffer = alloc_.reallocate(buffer_, capacity_, new_capacity);
+            if (buffer == nullptr) {
+                throw std::bad_alloc();
+            }
+            buffer_ = buffer;
+        }
+        capacity_ = new_capacity;
+    }
+
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    // Выделяет сырую память не менее чем под n элементов и возвращает указатель на неё.
+    // В n записывается фактическое число элементов, которые помещаются в блок
+    VECTOR_CONSTEXPR T* Allocate(size_t& n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        if constexpr (detail::kHasAllocateAtLeast<Alloc>) {
+            auto [ptr, count] = alloc_.allocate_at_least(n);
+            n = count;
+            return ptr;
+        } else {
+            return AllocTraits::allocate(alloc_, n);
+        }
     }
 
     // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    VECTOR_CONSTEXPR void Deallocate(T* buf) noexcept {
+        if (buf != nullptr) {
+            // Запас ёмкости мог быть отмечен недоступным, а память вернётся аллокатору
+            detail::AnnotateCapacity(buf, capacity_, 0, capacity_);
+            AllocTraits::deallocate(alloc_, buf, capacity_);
+        }
     }
 
+    [[no_unique_address]] Alloc alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+
+// Политика роста задаёт ёмкость, до которой увеличивается заполненный вектор:
+//     static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept;
+// capacity — текущая ёмкость, required — минимально необходимая, elem_size — sizeof(T).
+// Результат должен быть не меньше required. Без constexpr политика работает, но вектор с ней
+// нельзя использовать при константном вычислении
+
+// Удвоение ёмкости: 1, 2, 4, 8...
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+        const size_t doubled = capacity == 0 ? 1 : detail::SaturatingMul(capacity, 2);
+        return std::max(doubled, required);
+    }
+};
+
+// Рост в полтора раза: старые блоки со временем можно переиспользовать, а перерасход памяти
+// не превышает 50%
+struct GoldenGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+        const size_t grown = capacity + std::max<size_t>(capacity / 2, 1);
+        return std::max(grown < capacity ? SIZE_MAX : grown, required);
+    }
+};
+
+// Первое выделение сразу получает не менее MinCapacity элементов
+template <size_t MinCapacity, typename Base = DoublingGrowth>
+struct MinInitialCapacity {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, required, elem_size);
+        return capacity == 0 ? std::max(next, MinCapacity) : next;
+    }
+};
+
+// После ThresholdBytes ёмкость растёт линейно на StepBytes, ограничивая перерасход памяти
+// на очень больших векторах
+template <size_t ThresholdBytes, size_t StepBytes, typename Base = GoldenGrowth>
+struct CappedGrowth {
+    static_assert(StepBytes > 0);
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        if (detail::SaturatingMul(capacity, elem_size) < ThresholdBytes) {
+            return Base::NextCapacity(capacity, required, elem_size);
+        }
+        const size_t step = std::max<size_t>(StepBytes / elem_size, 1);
+        const size_t grown = capacity + step;
+        return std::max(grown < capacity ? SIZE_MAX : grown, required);
+    }
+};
+
+// Округляет размер блока вверх: до степени двойки (типичные классы размеров malloc)
+// для блоков меньше страницы и до целого числа страниц для остальных.
+// Так ёмкость использует память, которую аллокатор всё равно выделит
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct SizeClassGrowth {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, required, elem_size);
+        const size_t bytes = detail::SaturatingMul(next, elem_size);
+        if (bytes == SIZE_MAX) {
+            return next;
+        }
+        size_t rounded = bytes;
+        if (bytes < PageSize) {
+            rounded = 1;
+            while (rounded < bytes) {
+                rounded *= 2;
+            }
+        } else if (bytes % PageSize != 0) {
+            rounded = bytes - bytes % PageSize + PageSize;
+        }
+        return std::max(rounded / elem_size, next);
+    }
+};
+
+// Уменьшает ёмкость, когда размер становится меньше доли Num / Den от неё: буфер сжимается
+// до ёмкости, которую Base выбрала бы при росте до текущего размера. Между порогами роста
+// и сжатия остаётся зазор, поэтому чередование вставок и удалений не вызывает перевыделений
+// на каждой операции
+template <size_t Num = 1, size_t Den = 4, typename Base = DoublingGrowth>
+struct Hysteresis {
+    static_assert(0 < Num && Num < Den);
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        return Base::NextCapacity(capacity, required, elem_size);
+    }
+
+    static constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t elem_size) noexcept {
+        if (detail::SaturatingMul(size, Den) >= detail::SaturatingMul(capacity, Num)) {
+            return capacity;
+        }
+        return size == 0 ? 0 : std::min(capacity, Base::NextCapacity(size, size, elem_size));
+    }
+};
+
+// Политика статистики получает уведомления о работе вектора с памятью:
+//     void OnAllocate(size_t capacity) noexcept;      — выделен новый буфер (в том числе realloc)
+//     void OnExpandInPlace(size_t capacity) noexcept; — буфер увеличен на месте
+//     void OnRelocate(size_t count) noexcept;         — count элементов перенесены в другие ячейки
+//     void OnCopyFallback(size_t count) noexcept;     — из них скопированы, потому что
+//                                                       перемещение может выбросить исключение
+//     void Merge(const Stats& other) noexcept;        — вектор забрал буфер временного вектора
+// и предоставляет снимок счётчиков: StatsCounters Snapshot() const.
+// Счётчики следуют за буфером: перемещение и Swap передают их вместе с ним
+
+// Значения счётчиков статистики. operator<< выводит их в виде JSON-объекта
+struct StatsCounters {
+    size_t allocations = 0;
+    size_t peak_capacity = 0;
+    size_t relocated = 0;
+    size_t copy_fallbacks = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const StatsCounters& counters) {
+    return out << "{\"allocations\":" << counters.allocations
+               << ",\"peak_capacity\":" << counters.peak_capacity
+               << ",\"relocated\":" << counters.relocated
+               << ",\"copy_fallbacks\":" << counters.copy_fallbacks << '}';
+}
+
+// Перевыделение буфера вектора. new_capacity == 0 — буфер освобождён, в том числе
+// при разрушении вектора; при расширении на месте bytes_moved == 0.
+// move_nanoseconds — время переноса элементов в новый буфер
+struct ReallocationEvent {
+    size_t old_capacity = 0;
+    size_t new_capacity = 0;
+    size_t elem_size = 0;
+    size_t bytes_moved = 0;
+    uint64_t move_nanoseconds = 0;
+};
+
+// Политика статистики может получать события перевыделения для трассировки:
+//     void OnReallocation(const ReallocationEvent& event) noexcept;
+// Время переноса измеряется, только если политика его принимает или включены USDT-пробы
+
+namespace detail {
+
+template <typename Stats, typename = void>
+struct HasOnReallocation : std::false_type {};
+
+template <typename Stats>
+struct HasOnReallocation<Stats, std::void_t<decltype(std::declval<Stats&>().OnReallocation(
+    std::declval<const ReallocationEvent&>()))>> : std::true_type {};
+
+template <typename Stats>
+inline constexpr bool kHasOnReallocation = HasOnReallocation<Stats>::value;
+
+#ifdef VECTOR_HAS_USDT
+inline constexpr bool kHasUsdt = true;
+#else
+inline constexpr bool kHasUsdt = false;
+#endif
+
+inline void FireReallocationProbe(const ReallocationEvent& event) noexcept {
+#ifdef VECTOR_HAS_USDT
+    DTRACE_PROBE5(advanced_vector, reallocate, event.old_capacity, event.new_capacity
+                  , event.elem_size, event.bytes_moved, event.move_nanoseconds);
+#else
+    static_cast<void>(event);
+#endif
+}
+
+}  // namespace detail
+
+// Статистика выключена: пустой тип, вызовы которого компилятор полностью удаляет
+struct NoStats {
+    constexpr void OnAllocate(size_t /*capacity*/) noexcept {
+    }
+    constexpr void OnExpandInPlace(size_t /*capacity*/) noexcept {
+    }
+    constexpr void OnRelocate(size_t /*count*/) noexcept {
+    }
+    constexpr void OnCopyFallback(size_t /*count*/) noexcept {
+    }
+    constexpr void Merge(const NoStats& /*other*/) noexcept {
+    }
+    constexpr StatsCounters Snapshot() const noexcept {
+        return {};
+    }
+};
+
+// Счётчики отдельного экземпляра вектора
+class InstanceStats {
+public:
+    constexpr void OnAllocate(size_t capacity) noexcept {
+        ++counters_.allocations;
+        counters_.peak_capacity = std::max(counters_.peak_capacity, capacity);
+    }
+    constexpr void OnExpandInPlace(size_t capacity) noexcept {
+        counters_.peak_capacity = std::max(counters_.peak_capacity, capacity);
+    }
+    constexpr void OnRelocate(size_t count) noexcept {
+        counters_.relocated += count;
+    }
+    constexpr void OnCopyFallback(size_t count) noexcept {
+        counters_.copy_fallbacks += count;
+    }
+    constexpr void Merge(const InstanceStats& other) noexcept {
+        counters_.allocations += other.counters_.allocations;
+        counters_.peak_capacity = std::max(counters_.peak_capacity, other.counters_.peak_capacity);
+        counters_.relocated += other.counters_.relocated;
+        counters_.copy_fallbacks += other.counters_.copy_fallbacks;
+    }
+    constexpr StatsCounters Snapshot() const noexcept {
+        return counters_;
+    }
+
+private:
+    StatsCounters counters_;
+};
+
+// Счётчики, общие для всех векторов с одним и тем же тегом: тегом может быть метка места
+// вызова или сам тип элемента. Счётчики атомарны, векторы могут работать в разных потоках
+template <typename Tag>
+class TaggedStats {
+public:
+    void OnAllocate(size_t capacity) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        OnExpandInPlace(capacity);
+    }
+    void OnExpandInPlace(size_t capacity) noexcept {
+        size_t peak = peak_capacity_.load(std::memory_order_relaxed);
+        while (peak < capacity
+               && !peak_capacity_.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+    void OnRelocate(size_t count) noexcept {
+        relocated_.fetch_add(count, std::memory_order_relaxed);
+    }
+    void OnCopyFallback(size_t count) noexcept {
+        copy_fallbacks_.fetch_add(count, std::memory_order_relaxed);
+    }
+    // Временный вектор уже учтён в общих счётчиках
+    void Merge(const TaggedStats& /*other*/) noexcept {
+    }
+    StatsCounters Snapshot() const noexcept {
+        return Get();
+    }
+
+    static StatsCounters Get() noexcept {
+        return {allocations_.load(std::memory_order_relaxed)
+                , peak_capacity_.load(std::memory_order_relaxed)
+                , relocated_.load(std::memory_order_relaxed)
+                , copy_fallbacks_.load(std::memory_order_relaxed)};
+    }
+
+    static void Reset() noexcept {
+        allocations_ = 0;
+        peak_capacity_ = 0;
+        relocated_ = 0;
+        copy_fallbacks_ = 0;
+    }
+
+private:
+    inline static std::atomic<size_t> allocations_ = 0;
+    inline static std::atomic<size_t> peak_capacity_ = 0;
+    inline static std::atomic<size_t> relocated_ = 0;
+    inline static std::atomic<size_t> copy_fallbacks_ = 0;
+};
+
+// Функция трассировки TracingStats. Вызывается из потока, изменившего вектор,
+// и не должна выбрасывать исключений
+using TraceCallback = void (*)(const ReallocationEvent& event);
+
+namespace detail {
+
+inline std::atomic<TraceCallback> trace_callback = nullptr;
+
+}  // namespace detail
+
+// Устанавливает функцию трассировки для всех векторов с TracingStats
+// (nullptr отключает её) и возвращает прежнюю
+inline TraceCallback SetTraceCallback(TraceCallback callback) noexcept {
+    return detail::trace_callback.exchange(callback, std::memory_order_acq_rel);
+}
+
+// Счётчики Base и передача событий перевыделения в функцию из SetTraceCallback
+template <typename Base = NoStats>
+class TracingStats : public Base {
+public:
+    void OnReallocation(const ReallocationEvent& event) noexcept {
+        if (const TraceCallback callback = detail::trace_callback.load(std::memory_order_acquire)) {
+            callback(event);
+        }
+    }
+};
+
+// Политика переноса задаёт, чем вектор переносит элементы, перемещение которых может
+// выбросить исключение, а копирование — нет:
+//     static constexpr bool kForceMove;       — перемещать, отказавшись от строгой гарантии
+//     static constexpr bool kRequireNoexcept; — запрещать такой перенос при компиляции
+// Копирование вместо перемещения учитывает политика статистики в OnCopyFallback
+
+// Элементы копируются, и перевыделение сохраняет строгую гарантию, как у std::vector
+struct StrongRelocation {
+    static constexpr bool kForceMove = false;
+    static constexpr bool kRequireNoexcept = false;
+};
+
+// Элементы перемещаются всегда. Если перемещение выбросит исключение при перевыделении
+// или вставке, вектор сохраняет прежний размер, но часть его элементов может остаться
+// в состоянии после перемещения (базовая гарантия). Сдвиг хвоста при удалении тоже
+// перемещает элементы вместо копирования
+struct ForcedMoveRelocation {
+    static constexpr bool kForceMove = true;
+    static constexpr bool kRequireNoexcept = false;
+};
+
+// Вектор не компилируется, если при перевыделении или вставке ему пришлось бы копировать
+// элементы вместо перемещения. Помогает найти типы, у которых перемещение забыли пометить noexcept
+struct NoexceptRelocation {
+    static constexpr bool kForceMove = false;
+    static constexpr bool kRequireNoexcept = true;
+};
+
+namespace detail {
+
+// Переносит ли вектор с политикой Relocation элементы T перемещением
+template <typename T, typename Relocation>
+inline constexpr bool kRelocateByMove = Relocation::kForceMove || std::is_nothrow_move_constructible_v<T>
+                                        || !std::is_copy_constructible_v<T>;
+
+}  // namespace detail
+
+// Тег конструктора Vector(size, kDefaultInit): элементы инициализируются по умолчанию,
+// то есть тривиальные типы остаются неинициализированными вместо обнуления
+struct DefaultInitT {
+    explicit DefaultInitT() = default;
+};
+
+inline constexpr DefaultInitT kDefaultInit{};
+
+// Буфер, переданный из вектора или в вектор вместе с элементами: первые size из capacity
+// ячеек по адресу data содержат построенные элементы
 template <typename T>
+struct VectorBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+namespace detail {
+
+// Итератор вектора в режиме VECTOR_CHECK_ITERATORS. Помнит вектор и поколение его буфера
+// на момент создания и при разыменовании проверяет, что буфер с тех пор не заменялся,
+// а элемент ещё существует. Сдвиг элементов при вставке и удалении без перевыделения
+// не обнаруживается. После Swap и перемещения вектора итератор остаётся привязан
+// к прежнему объекту вектора и считается недействительным
+template <typename Owner, typename T>
+class CheckedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    CheckedIterator() = default;
+
+    VECTOR_CONSTEXPR CheckedIterator(const Owner* owner, T* ptr, size_t generation) noexcept
+        : owner_(owner)
+        , ptr_(ptr)
+        , generation_(generation) {
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator<Owner, U>& other) noexcept
+        : owner_(other.owner_)
+        , ptr_(other.ptr_)
+        , generation_(other.generation_) {
+    }
+
+    VECTOR_CONSTEXPR reference operator*() const noexcept {
+        Owner::CheckIterator(owner_, ptr_, generation_, true);
+        return *ptr_;
+    }
+
+    VECTOR_CONSTEXPR pointer operator->() const noexcept {
+        Owner::CheckIterator(owner_, ptr_, generation_, true);
+        return ptr_;
+    }
+
+    VECTOR_CONSTEXPR reference operator[](difference_type n) const noexcept {
+        return *(*this + n);
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator++() noexcept {
+        ++ptr_;
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator operator++(int) noexcept {
+        CheckedIterator old = *this;
+        ++ptr_;
+        return old;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator--() noexcept {
+        --ptr_;
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator operator--(int) noexcept {
+        CheckedIterator old = *this;
+        --ptr_;
+        return old;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator+=(difference_type n) noexcept {
+        ptr_ += n;
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator-=(difference_type n) noexcept {
+        ptr_ -= n;
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR friend CheckedIterator operator+(CheckedIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    VECTOR_CONSTEXPR friend CheckedIterator operator+(difference_type n, CheckedIterator it) noexcept {
+        return it += n;
+    }
+
+    VECTOR_CONSTEXPR friend CheckedIterator operator-(CheckedIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    // Сравнивать и вычитать можно только итераторы одного вектора
+    template <typename U>
+    VECTOR_CONSTEXPR difference_type operator-(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        CheckSameOwner(rhs);
+        return ptr_ - rhs.ptr_;
+    }
+
+    template <typename U>
+    VECTOR_CONSTEXPR bool operator==(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        CheckSameOwner(rhs);
+        return ptr_ == rhs.ptr_;
+    }
+
+    template <typename U>
+    VECTOR_CONSTEXPR bool operator!=(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+    template <typename U>
+    VECTOR_CONSTEXPR bool operator<(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        CheckSameOwner(rhs);
+        return ptr_ < rhs.ptr_;
+    }
+
+    template <typename U>
+    VECTOR_CONSTEXPR bool operator>(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        return rhs < *this;
+    }
+
+    template <typename U>
+    VECTOR_CONSTEXPR bool operator<=(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        return !(rhs < *this);
+    }
+
+    template <typename U>
+    VECTOR_CONSTEXPR bool operator>=(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        return !(*this < rhs);
+    }
+
+private:
+    template <typename, typename>
+    friend class CheckedIterator;
+    friend Owner;
+
+    template <typename U>
+    VECTOR_CONSTEXPR void CheckSameOwner(const CheckedIterator<Owner, U>& rhs) const noexcept {
+        if (owner_ != rhs.owner_) {
+            CheckFailed("iterators of different vectors", __FILE__, __LINE__);
+        }
+    }
+
+    const Owner* owner_ = nullptr;
+    T* ptr_ = nullptr;
+    size_t generation_ = 0;
+};
+
+}  // namespace detail
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth
+          , typename Stats = NoStats, typename Relocation = StrongRelocation>
 class Vector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public:
+    using value_type = T;
+    using allocator_type = Alloc;
+#ifdef VECTOR_CHECK_ITERATORS
+    using iterator = detail::CheckedIterator<Vector, T>;
+    using const_iterator = detail::CheckedIterator<Vector, const T>;
+#else
     using iterator = T*;
     using const_iterator = const T*;
+#endif
+
+    // Выравнивание адреса begin() непустого вектора
+    static constexpr size_t kAlignment = detail::AllocatorAlignment<Alloc>::value;
+
+    Vector() = default;
+
+    VECTOR_CONSTEXPR explicit Vector(const Alloc& alloc) noexcept
+        : data_(alloc) {
+    }
+
+    VECTOR_CONSTEXPR Vector(size_t size, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+        , size_(size)
+    {
+        OnConstructed();
+        detail::UninitializedValueConstructN(data_.GetAddress(), size_);
+        PoisonSpare();
+    }
+
+    Vector(size_t size, DefaultInitT, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+        , size_(size)
+    {
+        OnConstructed();
+        std::uninitialized_default_construct_n(data_.GetAddress(), size_);
+        PoisonSpare();
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    Vector(InputIt first, InputIt last, const Alloc& alloc = Alloc())
+        : data_(alloc)
+    {
+        Assign(first, last);
+    }
+
+    VECTOR_CONSTEXPR Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+    }
+
+    VECTOR_CONSTEXPR Vector(const Vector& other, const Alloc& alloc)
+        : data_(other.Size(), alloc)
+        , size_(other.Size())
+    {
+        OnConstructed();
+        detail::UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+        PoisonSpare();
+    }
 
-    Vector() = default;
+    VECTOR_CONSTEXPR Vector(Vector&& rhs) noexcept
+        : data_(std::move(rhs.data_))
+        , size_(std::exchange(rhs.size_, 0))
+        , stats_(std::exchange(rhs.stats_, Stats()))
+    {
+        rhs.InvalidateIterators();
+    }
 
-    Vector(size_t size)
-        : data_(size)
+    // Забирает буфер, первые size ячеек которого содержат построенные элементы
+    VECTOR_CONSTEXPR Vector(RawMemory<T, Alloc>&& buffer, size_t size) noexcept
+        : data_(std::move(buffer))
         , size_(size)
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size_);
+        VECTOR_ASSERT(size_ <= data_.Capacity());
+        PoisonSpare();
     }
 
-    Vector(const Vector& other)
-        : data_(other.Size())
-        , size_(other.Size())
+    // Буфер rhs забирается, только если его можно освободить аллокатором alloc,
+    // иначе элементы поштучно перемещаются в новую память
+    VECTOR_CONSTEXPR Vector(Vector&& rhs, const Alloc& alloc)
+        : data_(alloc)
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        if (alloc == rhs.GetAllocator()) {
+            data_.Swap(rhs.data_);
+            std::swap(size_, rhs.size_);
+            stats_ = std::exchange(rhs.stats_, Stats());
+            rhs.InvalidateIterators();
+        } else {
+            RawMemory<T, Alloc> buffer = AllocateBuffer(rhs.size_);
+            MoveOrCopy(rhs.data_.GetAddress(), rhs.size_, buffer.GetAddress());
+            data_.Swap(buffer);
+            size_ = rhs.size_;
+            PoisonSpare();
+        }
     }
 
-    Vector(Vector&& rhs) {
-        this->Swap(rhs);
+    // Параллельные варианты массовых операций делят работу на части, которые выполняет
+    // исполнитель exec (например, ThreadExecutor из thread_executor.h). Если конструктор элемента
+    // выбрасывает исключение, построенные элементы всех частей разрушаются, и гарантии
+    // безопасности совпадают с последовательными версиями
+    template <typename Executor, typename = detail::RequireExecutor<Executor>>
+    Vector(size_t size, Executor& exec, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+    {
+        OnConstructed();
+        T* dest = data_.GetAddress();
+        ParallelConstruct(exec, dest, size, [dest](size_t offset, size_t count) {
+            std::uninitialized_value_construct_n(dest + offset, count);
+        });
+        size_ = size;
+        PoisonSpare();
     }
 
-    ~Vector() {
-        std::destroy_n(data_.GetAddress(), size_);
+    template <typename Executor, typename = detail::RequireExecutor<Executor>>
+    Vector(const Vector& other, Executor& exec)
+        : data_(other.Size(), AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        OnConstructed();
+        const T* source = other.data_.GetAddress();
+        T* dest = data_.GetAddress();
+        ParallelConstruct(exec, dest, other.Size(), [source, dest](size_t offset, size_t count) {
+            std::uninitialized_copy_n(source + offset, count, dest + offset);
+        });
+        size_ = other.Size();
+        PoisonSpare();
     }
 
-    void Resize(size_t new_size) {
-        if (new_size == size_) {
-            return;
-        } else if (new_size > size_) {
-            if (new_size > this->Capacity()) {
-                Reserve(new_size);
-            }
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_
-                                                , new_size - size_);
-        } else {
-            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+    VECTOR_CONSTEXPR ~Vector() {
+        std::destroy_n(data_.GetAddress(), size_);
+        if (data_.Capacity() != 0) {
+            TraceReallocation(data_.Capacity(), 0, 0, {});
         }
+    }
+
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
+        ResizeWith(new_size, [](T* first, size_t n) {
+            detail::UninitializedValueConstructN(first, n);
+        });
+    }
+
+    // Как Resize, но новые элементы инициализируются по умолчанию: для тривиальных типов
+    // память не обнуляется, что экономит лишний проход по буферам, которые сразу перезаписываются
+    void ResizeDefaultInit(size_t new_size) {
+        ResizeWith(new_size, [](T* first, size_t n) {
+            std::uninitialized_default_construct_n(first, n);
+        });
+    }
+
+    // Только меняет размер, не трогая память новых элементов.
+    // Их значения не определены, пока не будут записаны
+    void ResizeUninitialized(size_t new_size) {
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "ResizeUninitialized requires a trivial element type");
+        CheckScope scope(*this, new_size > size_ ? new_size - size_ : 0);
+        Reserve(new_size);
         size_ = new_size;
     }
 
-    void PushBack(const T& value) {
+    VECTOR_CONSTEXPR void PushBack(const T& value) {
         EmplaceBack(value);
     }
 
-    void PushBack(T&& value) {
+    VECTOR_CONSTEXPR void PushBack(T&& value) {
         EmplaceBack(std::move(value));        
     }
 
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
+        CheckScope scope(*this, 1);
         if (size_ == this->Capacity()) {
-            RawMemory<T> buffer(size_ == 0 ? 1 : size_ * 2);
-            new (&buffer[size_]) T(std::forward<Args>(args)...);
-
-            MoveOrCopyAndSwap(data_, size_, buffer);
-
+            const size_t new_capacity = NextCapacity(size_ + 1);
+            if (TryExpand(new_capacity)) {
+                detail::ConstructAt(data_ + size_, std::forward<Args>(args)...);
+            } else if constexpr (kIsTriviallyRelocatable<T> && RawMemory<T, Alloc>::kCanReallocate) {
+                // Аргументы могут ссылаться на элементы вектора, поэтому элемент строится до перевыделения
+                alignas(T) unsigned char temp[sizeof(T)];
+                T* value = new (temp) T(std::forward<Args>(args)...);
+                ReallocateKeeping(new_capacity, value);
+                detail::Relocate(value, 1, data_.GetAddress() + size_);
+            } else {
+                RawMemory<T, Alloc> buffer = AllocateBuffer(new_capacity);
+                T* value = detail::ConstructAt(buffer + size_, std::forward<Args>(args)...);
+                try {
+                    MoveOrCopyAndSwap(data_, size_, buffer);
+                } catch (...) {
+                    std::destroy_at(value);
+                    throw;
+                }
+            }
         } else {
-            new (&data_[size_]) T(std::forward<Args>(args)...);
+            detail::ConstructAt(data_ + size_, std::forward<Args>(args)...);
         }
         ++size_;
         return (*this)[size_-1];
     }
 
-    void PopBack() noexcept {
+    VECTOR_CONSTEXPR void PopBack() noexcept {
+        CheckScope scope(*this);
         if (size_ > 0) {
             data_[size_ - 1].~T();
             --size_;
+            MaybeShrink();
         }
     }
 
-    void Reserve(size_t new_capacity) {
+    // Разрушает все элементы, сохраняя ёмкость для повторного заполнения
+    VECTOR_CONSTEXPR void Clear() noexcept {
+        CheckScope scope(*this);
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Разрушает элементы параллельно. Деструктор вектора работает последовательно,
+    // поэтому большой вектор стоит очистить так перед разрушением
+    template <typename Executor, typename = detail::RequireExecutor<Executor>>
+    void Clear(Executor& exec) noexcept {
+        CheckScope scope(*this);
+        ParallelDestroy(exec, data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Отдаёт буфер вместе с элементами, оставляя вектор пустым и без памяти.
+    // Новый владелец отвечает за разрушение элементов и освобождение буфера аллокатором,
+    // равным GetAllocator(), либо передаёт буфер в AdoptBuffer
+    [[nodiscard]] VectorBuffer<T> ReleaseBuffer() noexcept {
+        CheckScope scope(*this);
+        const VectorBuffer<T> buffer{data_.GetAddress(), std::exchange(size_, 0), data_.Capacity()};
+        data_.Release();
+        return buffer;
+    }
+
+    // Заменяет содержимое буфером buffer, выделенным аллокатором, равным GetAllocator(),
+    // например полученным из ReleaseBuffer другого вектора. Прежние элементы разрушаются,
+    // а прежний буфер освобождается
+    void AdoptBuffer(VectorBuffer<T> buffer) noexcept {
+        VECTOR_ASSERT(buffer.size <= buffer.capacity && (buffer.data != nullptr || buffer.capacity == 0));
+        CheckScope scope(*this);
+        ReleaseMemory();
+        RawMemory<T, Alloc> adopted(buffer.data, buffer.capacity, data_.GetAllocator());
+        data_.Swap(adopted);
+        size_ = buffer.size;
+    }
+
+    // Разрушает все элементы и освобождает буфер
+    void ReleaseMemory() noexcept {
+        CheckScope scope(*this);
+        Clear();
+        const size_t old_capacity = data_.Capacity();
+        RawMemory<T, Alloc> empty(data_.GetAllocator());
+        data_.Swap(empty);
+        if (old_capacity != 0) {
+            TraceReallocation(old_capacity, 0, 0, {});
+        }
+    }
+
+    // Уменьшает ёмкость до размера. Если перевыделить буфер не удалось, вектор не изменяется
+    void ShrinkToFit() {
+        CheckScope scope(*this);
+        ShrinkTo(size_);
+    }
+
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
+        if (new_capacity <= data_.Capacity()) {
+            return;
+        }
+        CheckScope scope(*this);
+        if (TryExpand(new_capacity)) {
+            return;
+        }
+        if constexpr (kIsTriviallyRelocatable<T> && RawMemory<T, Alloc>::kCanReallocate) {
+            ReallocateBuffer(new_capacity);
+        } else {
+            RawMemory<T, Alloc> buffer = AllocateBuffer(new_capacity);
+            MoveOrCopyAndSwap(data_, size_, buffer);
+        }
+    }
+
+    // Параллельный перенос элементов в новый буфер
+    template <typename Executor, typename = detail::RequireExecutor<Executor>>
+    void Reserve(size_t new_capacity, Executor& exec) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
-        RawMemory<T> buffer(new_capacity);
-        MoveOrCopyAndSwap(data_, size_, buffer);
+        CheckScope scope(*this);
+        if (TryExpand(new_capacity)) {
+            return;
+        }
+        RawMemory<T, Alloc> buffer = AllocateBuffer(new_capacity);
+        T* source = data_.GetAddress();
+        T* dest = buffer.GetAddress();
+        const size_t old_capacity = data_.Capacity();
+        const TraceClock::time_point start = TraceStart();
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            ParallelFor(exec, size_, [source, dest](size_t offset, size_t count) {
+                detail::Relocate(source + offset, count, dest + offset);
+            });
+        } else if constexpr (detail::kRelocateByMove<T, Relocation>) {
+            ParallelConstruct(exec, dest, size_, [source, dest](size_t offset, size_t count) {
+                std::uninitialized_move_n(source + offset, count, dest + offset);
+            });
+            ParallelDestroy(exec, source, size_);
+        } else {
+            static_assert(!Relocation::kRequireNoexcept,
+                          "NoexceptRelocation requires a noexcept move constructor of T");
+            ParallelConstruct(exec, dest, size_, [source, dest](size_t offset, size_t count) {
+                std::uninitialized_copy_n(source + offset, count, dest + offset);
+            });
+            ParallelDestroy(exec, source, size_);
+            stats_.OnCopyFallback(size_);
+        }
+        stats_.OnRelocate(size_);
+        data_.Swap(buffer);
+        TraceReallocation(old_capacity, data_.Capacity(), size_, start);
     }
 
-    void Swap(Vector& other) noexcept {
+    // Если аллокатор не распространяется при обмене, аллокаторы векторов должны быть равны.
+    // Статистика обменивается вместе с буферами
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
+        assert(AllocTraits::propagate_on_container_swap::value
+               || this->GetAllocator() == other.GetAllocator());
+        // Буферы переходят вместе с разметкой запаса, поэтому CheckScope не нужен
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
+        std::swap(stats_, other.stats_);
+        InvalidateIterators();
+        other.InvalidateIterators();
     }
 
-    size_t Size() const noexcept {
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
+    VECTOR_CONSTEXPR allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Адрес первого элемента. В отличие от begin(), всегда обычный указатель
+    VECTOR_CONSTEXPR T* Data() noexcept {
+        return data_.GetAddress();
+    }
+
+    VECTOR_CONSTEXPR const T* Data() const noexcept {
+        return data_.GetAddress();
+    }
+
+    // Статистика работы с памятью, которую собирает политика Stats
+    const Stats& GetStats() const noexcept {
+        return stats_;
+    }
+
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args) {
-        assert(pos >= this->begin() && pos <= this->end());
+        const size_t dist = Offset(pos);
+        CheckScope scope(*this, 1);
+        T* position = data_.GetAddress() + dist;
 
-        size_t dist = pos - this->begin();
-        iterator position = this->begin() + dist;
+        const size_t new_capacity = NextCapacity(size_ + 1);
+        if (size_ == this->Capacity() && !TryExpand(new_capacity)) {
+            if constexpr (kIsTriviallyRelocatable<T> && RawMemory<T, Alloc>::kCanReallocate) {
+                alignas(T) unsigned char temp[sizeof(T)];
+                T* value = new (temp) T(std::forward<Args>(args)...);
+                ReallocateKeeping(new_capacity, value);
+                position = data_.GetAddress() + dist;
+                InsertRelocated(position, value);
+                ++size_;
+                return scope.Finish(position);
+            }
 
-        if (size_ == this->Capacity()) {
-            RawMemory<T> buffer(size_ == 0 ? 1 : size_ * 2);
+            RawMemory<T, Alloc> buffer = AllocateBuffer(new_capacity);
             position = buffer.GetAddress() + dist;
             new (position) T(std::forward<Args>(args)...);
 
-            MoveOrCopy(data_.GetAddress(), dist, buffer.GetAddress());
-            MoveOrCopy(data_.GetAddress() + dist, size_ - dist, buffer.GetAddress() + (dist+1));
-            std::destroy_n(data_.GetAddress(), size_);
+            const size_t old_capacity = data_.Capacity();
+            const TraceClock::time_point start = TraceStart();
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                detail::Relocate(data_.GetAddress(), dist, buffer.GetAddress());
+                detail::Relocate(data_.GetAddress() + dist, size_ - dist, buffer.GetAddress() + (dist+1));
+                stats_.OnRelocate(size_);
+            } else {
+                try {
+                    MoveOrCopy(data_.GetAddress(), dist, buffer.GetAddress());
+                } catch (...) {
+                    position->~T();
+                    throw;
+                }
+                try {
+                    MoveOrCopy(data_.GetAddress() + dist, size_ - dist, buffer.GetAddress() + (dist+1));
+                } catch (...) {
+                    std::destroy_n(buffer.GetAddress(), dist + 1);
+                    throw;
+                }
+                std::destroy_n(data_.GetAddress(), size_);
+            }
 
             data_.Swap(buffer);
+            TraceReallocation(old_capacity, data_.Capacity(), size_, start);
 
         } else {
             if (dist == size_) {
                 new (position) T(std::forward<Args>(args)...);
+            } else if constexpr (kIsTriviallyRelocatable<T>) {
+                // Элемент строится во временном хранилище до сдвига: если конструктор
+                // выбросит исключение, вектор не изменится. Затем хвост сдвигается одним memmove,
+                // а новый элемент переносится в освободившуюся ячейку
+                alignas(T) unsigned char temp[sizeof(T)];
+                T* value = new (temp) T(std::forward<Args>(args)...);
+                InsertRelocated(position, value);
             } else {
-                T* temp = new T(std::forward<Args>(args)...);
-                new (this->end()) T(std::move(data_[size_  - 1]));
-                std::move_backward(position, this->end()-1, this->end());
-                position->~T();
-                data_[dist] = std::move(*temp);
+                // Элемент строится на стеке до сдвига: аргументы могут ссылаться на сдвигаемые
+                // элементы, а исключение в конструкторе оставляет вектор неизменным
+                T temp(std::forward<Args>(args)...);
+                T* end = data_.GetAddress() + size_;
+                new (end) T(std::move(data_[size_  - 1]));
+                std::move_backward(position, end - 1, end);
+                data_[dist] = std::move(temp);
             }
         }
 
         ++size_;
-        return position;
+        return scope.Finish(position);
     }
 
     iterator Insert(const_iterator pos, const T& value) {
@@ -224,103 +1492,785 @@ public:
         return Emplace(pos, std::move(value));
     }
 
+    // Вставляет count копий value перед pos, выделяя память не более одного раза
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        const size_t dist = Offset(pos);
+        if (&value >= data_.GetAddress() && &value < data_.GetAddress() + size_) {
+            // value будет сдвинут вместе с хвостом, поэтому вставляется его копия
+            const T copy(value);
+            return InsertN(dist, detail::RepeatIterator<T>(&copy, 0), count);
+        }
+        return InsertN(dist, detail::RepeatIterator<T>(&value, 0), count);
+    }
+
+    // Вставляет элементы [first, last) перед pos. Для прямых итераторов память выделяется
+    // не более одного раза, а хвост сдвигается один раз. Итераторы не должны указывать
+    // на элементы самого вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        const size_t dist = Offset(pos);
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            return InsertN(dist, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            // Длина диапазона неизвестна: элементы добавляются в конец и поворачиваются на место
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            T* begin = data_.GetAddress();
+            std::rotate(begin + dist, begin + old_size, begin + size_);
+            return MakeIterator(begin + dist);
+        }
+    }
+
+    // Добавляет в конец элементы [first, last)
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last) {
+        Insert(this->cend(), first, last);
+    }
+
+    // Заменяет содержимое вектора элементами [first, last), по возможности переиспользуя
+    // текущий буфер. Итераторы не должны указывать на элементы самого вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            CheckScope scope(*this, count > size_ ? count - size_ : 0);
+            ReplaceWith(first, count);
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    // Параллельный вариант Assign для итераторов произвольного доступа
+    template <typename RandomIt, typename Executor, typename = detail::RequireExecutor<Executor>>
+    void Assign(RandomIt first, RandomIt last, Executor& exec) {
+        static_assert(std::is_convertible_v<detail::IteratorCategory<RandomIt>, std::random_access_iterator_tag>,
+                      "parallel Assign needs random access iterators");
+        const size_t count = static_cast<size_t>(last - first);
+        CheckScope scope(*this, count > size_ ? count - size_ : 0);
+        if (count > data_.Capacity()) {
+            RawMemory<T, Alloc> buffer = AllocateBuffer(count);
+            T* dest = buffer.GetAddress();
+            ParallelConstruct(exec, dest, count, [first, dest](size_t offset, size_t n) {
+                std::uninitialized_copy_n(first + offset, n, dest + offset);
+            });
+            ParallelDestroy(exec, data_.GetAddress(), size_);
+            data_.Swap(buffer);
+            size_ = count;
+            return;
+        }
+        T* dest = data_.GetAddress();
+        ParallelFor(exec, std::min(size_, count), [first, dest](size_t offset, size_t n) {
+            std::copy_n(first + offset, n, dest + offset);
+        }, [](size_t, size_t) {});
+        if (count > size_) {
+            const RandomIt tail = first + size_;
+            T* tail_dest = dest + size_;
+            ParallelConstruct(exec, tail_dest, count - size_, [tail, tail_dest](size_t offset, size_t n) {
+                std::uninitialized_copy_n(tail + offset, n, tail_dest + offset);
+            });
+        } else {
+            ParallelDestroy(exec, dest + count, size_ - count);
+        }
+        size_ = count;
+    }
+
     iterator Erase(const_iterator pos) {
-        assert(pos >= this->begin() && pos <= this->end());
+        const size_t dist = Offset(pos);
+        VECTOR_ASSERT(dist < size_);
+        CheckScope scope(*this);
+        EraseN(dist, 1);
+        return scope.Finish(data_.GetAddress() + dist);
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t dist = Offset(first);
+        const size_t end = Offset(last);
+        VECTOR_ASSERT(dist <= end);
+        CheckScope scope(*this);
+        EraseN(dist, end - dist);
+        return scope.Finish(data_.GetAddress() + dist);
+    }
+
+    // Удаляет элементы, для которых pred возвращает true, за один проход: оставшиеся
+    // элементы сдвигаются к началу с сохранением порядка, освободившийся хвост уничтожается
+    // один раз. Если pred выбросил исключение, уже проверенные элементы остаются удалёнными,
+    // а непроверенные — на месте. Возвращает число удалённых элементов
+    template <typename Pred>
+    size_t EraseIf(Pred pred) {
+        CheckScope scope(*this);
+        T* begin = data_.GetAddress();
+        T* end = begin + size_;
+        T* write = std::find_if(begin, end, pred);
+        if (write == end) {
+            return 0;
+        }
+
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            // Удаляемые элементы уничтожаются сразу, а оставшиеся переносятся через пропуск
+            // [write, read) копированием байтов
+            T* read = write;
+            try {
+                write->~T();
+                for (++read; read != end; ++read) {
+                    if (pred(*read)) {
+                        read->~T();
+                    } else {
+                        std::memcpy(static_cast<void*>(write), read, sizeof(T));
+                        ++write;
+                    }
+                }
+            } catch (...) {
+                // Элемент *read ещё жив: непроверенный хвост сдвигается через пропуск
+                std::memmove(static_cast<void*>(write), read, (end - read) * sizeof(T));
+                size_ -= read - write;
+                throw;
+            }
+        } else {
+            T* read = write;
+            try {
+                for (++read; read != end; ++read) {
+                    if (!pred(*read)) {
+                        *write = detail::MoveAssignSource<Relocation::kForceMove>(*read);
+                        ++write;
+                    }
+                }
+            } catch (...) {
+                // В [write, read) остались удалённые или перенесённые элементы
+                EraseN(write - begin, read - write);
+                throw;
+            }
+            std::destroy(write, end);
+        }
+
+        const size_t erased = end - write;
+        size_ -= erased;
+        MaybeShrink();
+        return erased;
+    }
 
-        size_t dist = pos - data_.GetAddress();
-        iterator position = data_.GetAddress() + dist;
+    // Удаляет элемент за O(1), перенося на его место последний. Порядок элементов
+    // не сохраняется. Возвращает итератор на элемент, занявший место удалённого
+    iterator UnorderedErase(const_iterator pos) {
+        const size_t dist = Offset(pos);
+        VECTOR_ASSERT(dist < size_);
+        CheckScope scope(*this);
+        T* position = data_.GetAddress() + dist;
+        T* last = data_.GetAddress() + size_ - 1;
 
-        position->~T();
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::move(position + 1, this->end(), position);
+        if (position != last) {
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                position->~T();
+                std::memcpy(static_cast<void*>(position), last, sizeof(T));
+            } else {
+                *position = detail::MoveAssignSource<Relocation::kForceMove>(*last);
+                last->~T();
+            }
         } else {
-            std::copy(position + 1, this->end(), position);
+            last->~T();
         }
 
         --size_;
-        return position;
+        MaybeShrink();
+        return scope.Finish(data_.GetAddress() + dist);
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < size_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_ASSERT(index < size_);
         return data_[index];
     }
 
-    Vector& operator=(const Vector& rhs) {
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
-            if (rhs.size_ > data_.Capacity()) {
-                Vector temp(rhs);
-                this->Swap(temp);
-            } else {
-                CopyToFilledVector(*this, rhs);
+            CheckScope scope(*this, rhs.size_ > size_ ? rhs.size_ - size_ : 0);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                if (this->GetAllocator() != rhs.GetAllocator()) {
+                    // Старая память должна быть освобождена старым аллокатором,
+                    // поэтому копия строится аллокатором rhs и забирается вместе с ним
+                    Vector temp(rhs, rhs.GetAllocator());
+                    std::destroy_n(data_.GetAddress(), size_);
+                    size_ = 0;
+                    data_ = std::move(temp.data_);
+                    size_ = std::exchange(temp.size_, 0);
+                    stats_.Merge(temp.stats_);
+                    return *this;
+                }
             }
+            ReplaceWith(rhs.data_.GetAddress(), rhs.size_);
         }
         return *this;
     }
 
-    Vector& operator=(Vector&& other) {
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value
+        || AllocTraits::is_always_equal::value) {
         if (this != &other) {
-            this->Swap(other);
+            if constexpr (AllocTraits::is_always_equal::value) {
+                this->Swap(other);
+            } else if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                std::destroy_n(data_.GetAddress(), size_);
+                size_ = 0;
+                data_ = std::move(other.data_);
+                size_ = std::exchange(other.size_, 0);
+                InvalidateIterators();
+                other.InvalidateIterators();
+            } else if (this->GetAllocator() == other.GetAllocator()) {
+                this->Swap(other);
+            } else if (other.size_ <= data_.Capacity()) {
+                // Чужую память освободить нельзя: элементы перемещаются в текущий буфер
+                CheckScope scope(*this, other.size_ > size_ ? other.size_ - size_ : 0);
+                AssignToFilled(std::make_move_iterator(other.data_.GetAddress()), other.size_);
+            } else {
+                // Чужую память освободить нельзя, поэтому элементы перемещаются поштучно
+                Vector temp(std::move(other), this->GetAllocator());
+                this->Swap(temp);
+                stats_.Merge(temp.stats_);
+            }
         }
         return *this;
     }
 
-    iterator begin() noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR iterator begin() noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR iterator end() noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
-    const_iterator begin() const noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    const_iterator end() const noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR const_iterator end() const noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
-    const_iterator cbegin() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
         return this->begin();
     }
-    const_iterator cend() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept {
         return this->end();
     }
 
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Alloc> data_;
     size_t size_ = 0;
+    [[no_unique_address]] Stats stats_;
+#ifdef VECTOR_HAS_CHECK_SCOPE
+    detail::VectorChecks checks_;
+#endif
+
+#ifdef VECTOR_CHECK_ITERATORS
+    friend iterator;
+    friend const_iterator;
+#endif
 
 private:
-    void CopyToFilledVector(Vector& lhs, const Vector& rhs) {
-        const size_t& lhs_size = lhs.size_;
-        const size_t& rhs_size = rhs.Size();
+    // Изменяет размер, создавая недостающие элементы функцией construct(first, n)
+    template <typename Construct>
+    VECTOR_CONSTEXPR void ResizeWith(size_t new_size, Construct construct) {
+        if (new_size == size_) {
+            return;
+        }
+        CheckScope scope(*this, new_size > size_ ? new_size - size_ : 0);
+        if (new_size > size_) {
+            if (new_size > this->Capacity()) {
+                Reserve(new_size);
+            }
+            construct(data_.GetAddress() + size_, new_size - size_);
+        } else {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+        MaybeShrink();
+    }
+
+    // Удаляет count элементов, начиная с индекса dist, сдвигая хвост один раз
+    void EraseN(size_t dist, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        T* position = data_.GetAddress() + dist;
+        T* end = data_.GetAddress() + size_;
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            std::destroy_n(position, count);
+            std::memmove(static_cast<void*>(position), position + count
+                         , (size_ - dist - count) * sizeof(T));
+        } else {
+            // Хвост сдвигается присваиванием в живые объекты, уничтожаются освободившиеся последние
+            detail::MoveAssignOrCopy<Relocation::kForceMove>(position + count, end, position);
+            std::destroy_n(end - count, count);
+        }
+        size_ -= count;
+        MaybeShrink();
+    }
+
+    VECTOR_CONSTEXPR iterator MakeIterator(T* ptr) noexcept {
+#ifdef VECTOR_CHECK_ITERATORS
+        return iterator(this, ptr, checks_.generation);
+#else
+        return ptr;
+#endif
+    }
+
+    VECTOR_CONSTEXPR const_iterator MakeIterator(const T* ptr) const noexcept {
+#ifdef VECTOR_CHECK_ITERATORS
+        return const_iterator(this, ptr, checks_.generation);
+#else
+        return ptr;
+#endif
+    }
+
+    // Индекс позиции pos из [begin(), end()]. В режиме VECTOR_CHECK_ITERATORS заодно
+    // проверяет, что pos получен от этого вектора после последней замены буфера
+    VECTOR_CONSTEXPR size_t Offset(const_iterator pos) const noexcept {
+#ifdef VECTOR_CHECK_ITERATORS
+        if (pos.owner_ != this) {
+            detail::CheckFailed("iterator of another vector", __FILE__, __LINE__);
+        }
+        CheckIterator(this, pos.ptr_, pos.generation_, false);
+        return static_cast<size_t>(pos.ptr_ - data_.GetAddress());
+#else
+        VECTOR_ASSERT(pos >= data_.GetAddress() && pos <= data_.GetAddress() + size_);
+        return static_cast<size_t>(pos - data_.GetAddress());
+#endif
+    }
+
+#ifdef VECTOR_CHECK_ITERATORS
+    // Итератор получен от вектора owner после последней замены его буфера и указывает
+    // в [begin(), end()], а если его разыменовывают, — в [begin(), end())
+    static VECTOR_CONSTEXPR void CheckIterator(const Vector* owner, const T* ptr, size_t generation
+                                               , bool dereference) noexcept {
+        if (owner == nullptr) {
+            detail::CheckFailed("iterator is not bound to a vector", __FILE__, __LINE__);
+        }
+        if (generation != owner->checks_.generation) {
+            detail::CheckFailed("iterator invalidated by reallocation", __FILE__, __LINE__);
+        }
+        const T* begin = owner->data_.GetAddress();
+        const T* end = begin + owner->size_;
+        if (ptr < begin || ptr > end || (dereference && ptr == end)) {
+            detail::CheckFailed("iterator out of range", __FILE__, __LINE__);
+        }
+    }
+#endif
+
+    VECTOR_CONSTEXPR void InvalidateIterators() noexcept {
+#ifdef VECTOR_CHECK_ITERATORS
+        ++checks_.generation;
+#endif
+    }
+
+    // Отмечает запас ёмкости только что заполненного буфера недоступным для AddressSanitizer
+    VECTOR_CONSTEXPR void PoisonSpare() noexcept {
+        detail::AnnotateCapacity(data_.GetAddress(), data_.Capacity(), data_.Capacity(), size_);
+    }
+
+#ifdef VECTOR_HAS_CHECK_SCOPE
+    // Изменяющая операция в режиме проверок. К её концу запас ёмкости снова отмечен
+    // недоступным для AddressSanitizer, а замена буфера делает прежние итераторы
+    // недействительными. grow — сколько ячеек запаса операция может занять в текущем буфере.
+    // Новый буфер доступен целиком. Вложенные операции размечает только внешняя
+    class CheckScope {
+    public:
+        VECTOR_CONSTEXPR explicit CheckScope(Vector& vector, size_t grow = 0) noexcept
+            : vector_(vector)
+            , buffer_(vector.data_.GetAddress())
+            , capacity_(vector.data_.Capacity())
+            , accessible_(vector.size_ + std::min(grow, capacity_ - vector.size_))
+            , outer_(vector.checks_.depth++ == 0)
+        {
+            if (outer_) {
+                detail::AnnotateCapacity(buffer_, capacity_, vector.size_, accessible_);
+            }
+        }
+
+        CheckScope(const CheckScope&) = delete;
+        CheckScope& operator=(const CheckScope&) = delete;
+
+        VECTOR_CONSTEXPR ~CheckScope() {
+            if (!finished_) {
+                Close();
+            }
+        }
+
+        // Завершает операцию раньше деструктора, чтобы возвращаемый итератор получил
+        // поколение уже после замены буфера
+        VECTOR_CONSTEXPR iterator Finish(T* ptr) noexcept {
+            Close();
+            finished_ = true;
+            return vector_.MakeIterator(ptr);
+        }
+
+    private:
+        VECTOR_CONSTEXPR void Close() noexcept {
+            --vector_.checks_.depth;
+            if (!outer_) {
+                return;
+            }
+            const T* buffer = vector_.data_.GetAddress();
+            const size_t capacity = vector_.data_.Capacity();
+            const size_t size = vector_.size_;
+            if (buffer != buffer_) {
+                vector_.InvalidateIterators();
+                detail::AnnotateCapacity(buffer, capacity, capacity, size);
+            } else if (capacity != capacity_) {
+                detail::AnnotateCapacity(buffer, capacity, capacity, size);
+            } else {
+                detail::AnnotateCapacity(buffer, capacity, std::max(accessible_, size), size);
+            }
+        }
+
+        Vector& vector_;
+        const T* buffer_;
+        size_t capacity_;
+        size_t accessible_;
+        bool outer_;
+        bool finished_ = false;
+    };
+#else
+    class CheckScope {
+    public:
+        VECTOR_CONSTEXPR explicit CheckScope(Vector& vector, size_t /*grow*/ = 0) noexcept
+            : vector_(vector)
+        {
+        }
+
+        VECTOR_CONSTEXPR iterator Finish(T* ptr) noexcept {
+            return vector_.MakeIterator(ptr);
+        }
+
+    private:
+        Vector& vector_;
+    };
+#endif
+
+    // Перевыделяет буфер под new_capacity >= size_ элементов, если это меньше текущей ёмкости
+    VECTOR_CONSTEXPR void ShrinkTo(size_t new_capacity) {
+        assert(new_capacity >= size_);
+        if (new_capacity >= data_.Capacity()) {
+            return;
+        }
+        if (new_capacity == 0) {
+            RawMemory<T, Alloc> empty(data_.GetAllocator());
+            data_.Swap(empty);
+            TraceReallocation(empty.Capacity(), 0, 0, {});
+        } else if constexpr (kIsTriviallyRelocatable<T> && RawMemory<T, Alloc>::kCanReallocate) {
+            ReallocateBuffer(new_capacity);
+        } else {
+            RawMemory<T, Alloc> buffer = AllocateBuffer(new_capacity);
+            MoveOrCopyAndSwap(data_, size_, buffer);
+        }
+    }
+
+    // Сжимает буфер, если этого требует политика роста. Сжатие лишь экономит память,
+    // поэтому ошибка перевыделения игнорируется и вектор остаётся прежним
+    VECTOR_CONSTEXPR void MaybeShrink() noexcept {
+        if constexpr (detail::kHasShrinkCapacity<Growth>) {
+            const size_t new_capacity = Growth::ShrinkCapacity(data_.Capacity(), size_, sizeof(T));
+            if (new_capacity < data_.Capacity()) {
+                try {
+                    ShrinkTo(new_capacity);
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Ёмкость, до которой растёт вектор, когда ему нужно вместить required элементов
+    VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(data_.Capacity(), required, sizeof(T));
+    }
+
+    // Выделяет буфер тем же аллокатором, которым владеет вектор
+    VECTOR_CONSTEXPR RawMemory<T, Alloc> AllocateBuffer(size_t capacity) {
+        RawMemory<T, Alloc> buffer(capacity, data_.GetAllocator());
+        if (buffer.Capacity() != 0) {
+            stats_.OnAllocate(buffer.Capacity());
+        }
+        return buffer;
+    }
+
+    // Учитывает буфер, выделенный в списке инициализации конструктора
+    VECTOR_CONSTEXPR void OnConstructed() noexcept {
+        if (data_.Capacity() != 0) {
+            stats_.OnAllocate(data_.Capacity());
+        }
+    }
+
+    // Увеличивает буфер на месте средствами аллокатора, если он это поддерживает
+    VECTOR_CONSTEXPR bool TryExpand(size_t new_capacity) noexcept {
+        const size_t old_capacity = data_.Capacity();
+        if (data_.TryExpand(new_capacity)) {
+            stats_.OnExpandInPlace(new_capacity);
+            TraceReallocation(old_capacity, new_capacity, 0, {});
+            return true;
+        }
+        return false;
+    }
+
+    // Перевыделения трассируются, если их принимает политика Stats или включены USDT-пробы
+    static constexpr bool kTraced = detail::kHasOnReallocation<Stats> || detail::kHasUsdt;
+
+    using TraceClock = std::chrono::steady_clock;
+
+    // Начало переноса элементов. Часы читаются, только если перевыделения трассируются
+    VECTOR_CONSTEXPR static TraceClock::time_point TraceStart() noexcept {
+        if constexpr (kTraced) {
+            if (!detail::IsConstantEvaluated()) {
+                return TraceClock::now();
+            }
+        }
+        return {};
+    }
+
+    // Сообщает о замене буфера, под которым moved элементов перенесены, начиная с момента start
+    VECTOR_CONSTEXPR void TraceReallocation(size_t old_capacity, size_t new_capacity, size_t moved
+                                            , TraceClock::time_point start) noexcept {
+        if constexpr (kTraced) {
+            if (detail::IsConstantEvaluated()) {
+                return;
+            }
+            ReallocationEvent event{old_capacity, new_capacity, sizeof(T), moved * sizeof(T), 0};
+            if (moved != 0) {
+                event.move_nanoseconds = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(TraceClock::now() - start).count());
+            }
+            detail::FireReallocationProbe(event);
+            if constexpr (detail::kHasOnReallocation<Stats>) {
+                stats_.OnReallocation(event);
+            }
+        }
+    }
+
+    // Перевыделяет буфер тривиально перемещаемых элементов средствами аллокатора
+    void ReallocateBuffer(size_t new_capacity) {
+        const size_t old_capacity = data_.Capacity();
+        const TraceClock::time_point start = TraceStart();
+        data_.Reallocate(new_capacity);
+        stats_.OnAllocate(data_.Capacity());
+        stats_.OnRelocate(size_);
+        TraceReallocation(old_capacity, data_.Capacity(), size_, start);
+    }
 
-        const size_t min_size = std::min(lhs_size, rhs_size);
-        std::copy(rhs.begin(), rhs.end(), lhs.begin());
-        if (min_size == lhs_size) {
-            std::uninitialized_copy_n(rhs.data_.GetAddress() + lhs_size
-                                    , rhs_size - lhs_size
-                                    , lhs.data_.GetAddress() + lhs_size);
+    // Присваивает вектору n элементов, начиная с first, в пределах текущей ёмкости:
+    // общая часть присваивается, недостающие элементы создаются, лишние разрушаются
+    template <typename InputIt>
+    VECTOR_CONSTEXPR void AssignToFilled(InputIt first, size_t n) {
+        assert(n <= data_.Capacity());
+        const size_t common = std::min(size_, n);
+        for (size_t i = 0; i < common; ++i, ++first) {
+            data_[i] = *first;
+        }
+        if (n > size_) {
+            detail::UninitializedCopyN(first, n - size_, data_.GetAddress() + size_);
+        } else {
+            std::destroy_n(data_.GetAddress() + n, size_ - n);
+        }
+        size_ = n;
+    }
+
+    // Заменяет содержимое count элементами, начиная с first. Текущий буфер переиспользуется,
+    // если вмещает их или расширяется на месте. Иначе копия строится в новом буфере
+    // до разрушения старых элементов, и при исключении вектор не меняется
+    template <typename ForwardIt>
+    VECTOR_CONSTEXPR void ReplaceWith(ForwardIt first, size_t count) {
+        if (count <= data_.Capacity() || TryExpand(count)) {
+            AssignToFilled(first, count);
+            return;
+        }
+        RawMemory<T, Alloc> buffer = AllocateBuffer(count);
+        detail::UninitializedCopyN(first, count, buffer.GetAddress());
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.Swap(buffer);
+        size_ = count;
+        TraceReallocation(buffer.Capacity(), data_.Capacity(), 0, {});
+    }
+
+    // Вставляет count элементов, начиная с first, перед pos
+    template <typename ForwardIt>
+    iterator InsertN(size_t dist, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return MakeIterator(data_.GetAddress() + dist);
+        }
+        CheckScope scope(*this, count);
+
+        const size_t new_capacity = NextCapacity(size_ + count);
+        if (size_ + count > this->Capacity() && !TryExpand(new_capacity)) {
+            RawMemory<T, Alloc> buffer = AllocateBuffer(new_capacity);
+            T* hole = buffer.GetAddress() + dist;
+            std::uninitialized_copy_n(first, count, hole);
+
+            const size_t old_capacity = data_.Capacity();
+            const TraceClock::time_point start = TraceStart();
+
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                detail::Relocate(data_.GetAddress(), dist, buffer.GetAddress());
+                detail::Relocate(data_.GetAddress() + dist, size_ - dist, hole + count);
+                stats_.OnRelocate(size_);
+            } else {
+                try {
+                    MoveOrCopy(data_.GetAddress(), dist, buffer.GetAddress());
+                } catch (...) {
+                    std::destroy_n(hole, count);
+                    throw;
+                }
+                try {
+                    MoveOrCopy(data_.GetAddress() + dist, size_ - dist, hole + count);
+                } catch (...) {
+                    std::destroy_n(buffer.GetAddress(), dist + count);
+                    throw;
+                }
+                std::destroy_n(data_.GetAddress(), size_);
+            }
+            data_.Swap(buffer);
+            TraceReallocation(old_capacity, data_.Capacity(), size_, start);
+            size_ += count;
+            return scope.Finish(data_.GetAddress() + dist);
         }
-        if (min_size == rhs_size && rhs_size != lhs_size) {
-            std::destroy_n(lhs.data_.GetAddress() + rhs_size, lhs_size - rhs_size);
+
+        T* position = data_.GetAddress() + dist;
+        T* old_end = data_.GetAddress() + size_;
+        const size_t elems_after = size_ - dist;
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            std::memmove(static_cast<void*>(position + count), position, elems_after * sizeof(T));
+            try {
+                std::uninitialized_copy_n(first, count, position);
+            } catch (...) {
+                std::memmove(static_cast<void*>(position), position + count, elems_after * sizeof(T));
+                throw;
+            }
+            size_ += count;
+        } else if (elems_after > count) {
+            MoveOrCopy(old_end - count, count, old_end);
+            size_ += count;
+            std::move_backward(position, old_end - count, old_end);
+            std::copy_n(first, count, position);
+        } else {
+            ForwardIt mid = std::next(first, static_cast<std::ptrdiff_t>(elems_after));
+            std::uninitialized_copy_n(mid, count - elems_after, old_end);
+            size_ += count - elems_after;
+            MoveOrCopy(position, elems_after, old_end + (count - elems_after));
+            size_ += elems_after;
+            std::copy_n(first, elems_after, position);
         }
-        lhs.size_ = rhs_size;
+        return scope.Finish(position);
     }
 
-    void MoveOrCopy(T* src, size_t n, T* dest) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(src, n, dest);
+    VECTOR_CONSTEXPR void MoveOrCopy(T* src, size_t n, T* dest) {
+        if constexpr (detail::kRelocateByMove<T, Relocation>) {
+            detail::UninitializedMoveN(src, n, dest);
         } else {
-            std::uninitialized_copy_n(src, n, dest);
+            static_assert(!Relocation::kRequireNoexcept,
+                          "NoexceptRelocation requires a noexcept move constructor of T");
+            detail::UninitializedCopyN(src, n, dest);
+            stats_.OnCopyFallback(n);
+        }
+        stats_.OnRelocate(n);
+    }
+
+    // Сдвигает хвост, начиная с position, на одну ячейку вправо и переносит
+    // в освободившуюся ячейку объект value, построенный во временном хранилище
+    void InsertRelocated(T* position, T* value) noexcept {
+        std::memmove(static_cast<void*>(position + 1), position
+                     , static_cast<size_t>(data_.GetAddress() + size_ - position) * sizeof(T));
+        detail::Relocate(value, 1, position);
+    }
+
+    // Перевыделяет буфер средствами аллокатора. Если это не удалось,
+    // разрушает уже построенный во временном хранилище элемент value
+    void ReallocateKeeping(size_t new_capacity, T* value) {
+        try {
+            ReallocateBuffer(new_capacity);
+        } catch (...) {
+            value->~T();
+            throw;
+        }
+    }
+
+    // Делит [0, n) на части и параллельно вызывает op(offset, count) для каждой.
+    // Если часть выбросила исключение, для остальных частей вызывается cleanup(offset, count),
+    // и первое исключение пробрасывается дальше
+    template <typename Executor, typename Op, typename Cleanup>
+    static void ParallelFor(Executor& exec, size_t n, Op op, Cleanup cleanup) {
+        const size_t by_size = detail::SaturatingMul(n, sizeof(T)) / detail::kParallelGrainBytes;
+        const size_t chunks = std::max<size_t>(1, std::min(exec.Concurrency(), by_size));
+        if (chunks == 1) {
+            op(0, n);
+            return;
+        }
+        std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[chunks]);
+        exec.Run(chunks, [&](size_t chunk) noexcept {
+            const size_t begin = detail::ChunkBegin(n, chunks, chunk);
+            try {
+                op(begin, detail::ChunkBegin(n, chunks, chunk + 1) - begin);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        });
+        const auto failed = std::find_if(errors.get(), errors.get() + chunks
+                                         , [](const std::exception_ptr& e) { return e != nullptr; });
+        if (failed == errors.get() + chunks) {
+            return;
+        }
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (errors[chunk] == nullptr) {
+                const size_t begin = detail::ChunkBegin(n, chunks, chunk);
+                cleanup(begin, detail::ChunkBegin(n, chunks, chunk + 1) - begin);
+            }
+        }
+        std::rethrow_exception(*failed);
+    }
+
+    template <typename Executor, typename Op>
+    static void ParallelFor(Executor& exec, size_t n, Op op) noexcept {
+        ParallelFor(exec, n, op, [](size_t, size_t) {});
+    }
+
+    // Параллельно строит n элементов в dest. op(offset, count), как std::uninitialized_*,
+    // при исключении разрушает построенные им элементы своей части
+    template <typename Executor, typename Op>
+    static void ParallelConstruct(Executor& exec, T* dest, size_t n, Op op) {
+        ParallelFor(exec, n, op, [dest](size_t offset, size_t count) {
+            std::destroy_n(dest + offset, count);
+        });
+    }
+
+    template <typename Executor>
+    static void ParallelDestroy(Executor& exec, T* first, size_t n) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            ParallelFor(exec, n, [first](size_t offset, size_t count) {
+                std::destroy_n(first + offset, count);
+            });
         }
     }
 
-    void MoveOrCopyAndSwap(RawMemory<T>& data, size_t n_elems, RawMemory<T>& buf) {
-        MoveOrCopy(data.GetAddress(), n_elems, buf.GetAddress());
-        std::destroy_n(data.GetAddress(), n_elems);
+    VECTOR_CONSTEXPR void MoveOrCopyAndSwap(RawMemory<T, Alloc>& data, size_t n_elems, RawMemory<T, Alloc>& buf) {
+        const size_t old_capacity = data.Capacity();
+        const TraceClock::time_point start = TraceStart();
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            detail::Relocate(data.GetAddress(), n_elems, buf.GetAddress());
+            stats_.OnRelocate(n_elems);
+        } else {
+            MoveOrCopy(data.GetAddress(), n_elems, buf.GetAddress());
+            std::destroy_n(data.GetAddress(), n_elems);
+        }
         data.Swap(buf);
+        TraceReallocation(old_capacity, data.Capacity(), n_elems, start);
     }
-};
\ No newline at end of file
+};
+
+namespace pmr {
+
+// Вектор, память которого берётся из std::pmr::memory_resource
+template <typename T>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
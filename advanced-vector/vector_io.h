@@ -0,0 +1,301 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define VECTOR_IO_HAS_SPAN 1
+#endif
+
+// Двоичная сериализация Vector. Формат: число элементов uint64_t, за которым следуют
+// байты элементов подряд. Элементами могут быть тривиально копируемые типы и вложенные
+// Vector из них; числа записываются в порядке байтов машины.
+// Тривиально копируемые элементы пишутся и читаются одним блоком прямо из буфера вектора
+// и в него, без промежуточных копий. ReadFrom выделяет память один раз по длине из префикса
+// и даёт строгую гарантию: при ошибке вектор не меняется
+
+namespace detail {
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+struct IsVector<Vector<T, Alloc, Growth, Stats, Relocation>> : std::true_type {};
+
+template <typename T>
+constexpr bool IsSerializable() noexcept {
+    if constexpr (IsVector<T>::value) {
+        return IsSerializable<typename T::value_type>();
+    } else {
+        return std::is_trivially_copyable_v<T>;
+    }
+}
+
+[[noreturn]] inline void ThrowSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+[[noreturn]] inline void ThrowUnexpectedEnd() {
+    throw std::runtime_error("unexpected end of serialized vector");
+}
+
+// Записывает все буферы iov, повторяя writev после частичной записи
+inline void WriteAll(int fd, iovec* iov, int count, const std::string& what) {
+    while (count > 0) {
+        const ssize_t written = ::writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError(what);
+        }
+        size_t rest = static_cast<size_t>(written);
+        while (count > 0 && rest >= iov->iov_len) {
+            rest -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + rest;
+            iov->iov_len -= rest;
+        }
+    }
+}
+
+inline void WriteAll(int fd, const void* data, size_t size, const std::string& what) {
+    iovec iov{const_cast<void*>(data), size};
+    WriteAll(fd, &iov, 1, what);
+}
+
+inline void ReadAll(int fd, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t got = ::read(fd, bytes, size);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("read");
+        }
+        if (got == 0) {
+            ThrowUnexpectedEnd();
+        }
+        bytes += got;
+        size -= static_cast<size_t>(got);
+    }
+}
+
+// Переводит длину из префикса в число элементов, отбрасывая длины, которые не помещаются
+// в size_t или в память
+template <typename T>
+size_t CheckedLength(uint64_t length) {
+    if (length > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::length_error("serialized vector is too long");
+    }
+    return static_cast<size_t>(length);
+}
+
+// Читает n тривиально копируемых элементов функцией read(void*, size_t) в новый буфер
+// и заменяет им содержимое v
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation, typename Read>
+void ReadTrivial(Vector<T, Alloc, Growth, Stats, Relocation>& v, size_t n, Read&& read) {
+    RawMemory<T, Alloc> buffer(n, v.GetAllocator());
+    read(static_cast<void*>(buffer.GetAddress()), n * sizeof(T));
+    Vector<T, Alloc, Growth, Stats, Relocation> result(std::move(buffer), n);
+    v.Swap(result);
+}
+
+// Читает n вложенных векторов функцией read_element(Element&)
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation, typename ReadElement>
+void ReadNested(Vector<T, Alloc, Growth, Stats, Relocation>& v, size_t n, ReadElement&& read_element) {
+    Vector<T, Alloc, Growth, Stats, Relocation> result(v.GetAllocator());
+    result.Reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        T element;
+        read_element(element);
+        result.EmplaceBack(std::move(element));
+    }
+    v.Swap(result);
+}
+
+}  // namespace detail
+
+// Размер сериализованного вектора в байтах
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+size_t SerializedSize(const Vector<T, Alloc, Growth, Stats, Relocation>& v) noexcept {
+    size_t size = sizeof(uint64_t);
+    if constexpr (detail::IsVector<T>::value) {
+        for (const T& element : v) {
+            size += SerializedSize(element);
+        }
+    } else {
+        size += v.Size() * sizeof(T);
+    }
+    return size;
+}
+
+// Потоки. Ошибка записи или чтения выбрасывает std::ios_base::failure
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+void WriteTo(std::ostream& os, const Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(detail::IsSerializable<T>(), "elements must be trivially copyable or vectors of them");
+    const uint64_t length = v.Size();
+    os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    if constexpr (detail::IsVector<T>::value) {
+        for (const T& element : v) {
+            WriteTo(os, element);
+        }
+    } else {
+        os.write(reinterpret_cast<const char*>(v.Data()), static_cast<std::streamsize>(v.Size() * sizeof(T)));
+    }
+    if (!os) {
+        throw std::ios_base::failure("failed to write vector");
+    }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+void ReadFrom(std::istream& is, Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(detail::IsSerializable<T>(), "elements must be trivially copyable or vectors of them");
+    const auto read = [&is](void* data, size_t size) {
+        is.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(is.gcount()) != size) {
+            throw std::ios_base::failure("unexpected end of serialized vector");
+        }
+    };
+    uint64_t length = 0;
+    read(&length, sizeof(length));
+    const size_t n = detail::CheckedLength<T>(length);
+    if constexpr (detail::IsVector<T>::value) {
+        detail::ReadNested(v, n, [&is](T& element) {
+            ReadFrom(is, element);
+        });
+    } else {
+        detail::ReadTrivial(v, n, read);
+    }
+}
+
+// Файловые дескрипторы. Префикс и элементы пишутся одним вызовом writev.
+// Ошибки выбрасывают std::system_error, а преждевременный конец данных — std::runtime_error
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+void WriteTo(int fd, const Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(detail::IsSerializable<T>(), "elements must be trivially copyable or vectors of them");
+    uint64_t length = v.Size();
+    if constexpr (detail::IsVector<T>::value) {
+        detail::WriteAll(fd, &length, sizeof(length), "write");
+        for (const T& element : v) {
+            WriteTo(fd, element);
+        }
+    } else {
+        iovec iov[2] = {
+            {&length, sizeof(length)},
+            {const_cast<T*>(v.Data()), v.Size() * sizeof(T)},
+        };
+        detail::WriteAll(fd, iov, 2, "writev");
+    }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+void ReadFrom(int fd, Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(detail::IsSerializable<T>(), "elements must be trivially copyable or vectors of them");
+    uint64_t length = 0;
+    detail::ReadAll(fd, &length, sizeof(length));
+    const size_t n = detail::CheckedLength<T>(length);
+    if constexpr (detail::IsVector<T>::value) {
+        detail::ReadNested(v, n, [fd](T& element) {
+            ReadFrom(fd, element);
+        });
+    } else {
+        detail::ReadTrivial(v, n, [fd](void* data, size_t size) {
+            detail::ReadAll(fd, data, size);
+        });
+    }
+}
+
+// Байтовые буферы [first, last). WriteTo возвращает конец записанных данных и выбрасывает
+// std::length_error, если буфер меньше SerializedSize(v). ReadFrom возвращает позицию
+// после прочитанного вектора
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+std::byte* WriteTo(std::byte* first, std::byte* last, const Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(detail::IsSerializable<T>(), "elements must be trivially copyable or vectors of them");
+    if (static_cast<size_t>(last - first) < SerializedSize(v)) {
+        throw std::length_error("buffer is too small for serialized vector");
+    }
+    const uint64_t length = v.Size();
+    std::memcpy(first, &length, sizeof(length));
+    first += sizeof(length);
+    if constexpr (detail::IsVector<T>::value) {
+        for (const T& element : v) {
+            first = WriteTo(first, last, element);
+        }
+    } else if (v.Size() > 0) {
+        std::memcpy(first, v.Data(), v.Size() * sizeof(T));
+        first += v.Size() * sizeof(T);
+    }
+    return first;
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+const std::byte* ReadFrom(const std::byte* first, const std::byte* last, Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    static_assert(detail::IsSerializable<T>(), "elements must be trivially copyable or vectors of them");
+    uint64_t length = 0;
+    if (static_cast<size_t>(last - first) < sizeof(length)) {
+        detail::ThrowUnexpectedEnd();
+    }
+    std::memcpy(&length, first, sizeof(length));
+    first += sizeof(length);
+    const size_t n = detail::CheckedLength<T>(length);
+    if constexpr (detail::IsVector<T>::value) {
+        // Каждый вложенный вектор занимает хотя бы префикс длины
+        if (n > static_cast<size_t>(last - first) / sizeof(uint64_t)) {
+            detail::ThrowUnexpectedEnd();
+        }
+        detail::ReadNested(v, n, [&first, last](T& element) {
+            first = ReadFrom(first, last, element);
+        });
+    } else {
+        // Длина проверяется до выделения памяти
+        if (n > static_cast<size_t>(last - first) / sizeof(T)) {
+            detail::ThrowUnexpectedEnd();
+        }
+        detail::ReadTrivial(v, n, [&first](void* data, size_t size) {
+            if (size > 0) {
+                std::memcpy(data, first, size);
+                first += size;
+            }
+        });
+    }
+    return first;
+}
+
+#ifdef VECTOR_IO_HAS_SPAN
+// Перегрузки для std::span возвращают неиспользованный остаток буфера
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+std::span<std::byte> WriteTo(std::span<std::byte> out, const Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    std::byte* end = WriteTo(out.data(), out.data() + out.size(), v);
+    return out.subspan(static_cast<size_t>(end - out.data()));
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+std::span<const std::byte> ReadFrom(std::span<const std::byte> in, Vector<T, Alloc, Growth, Stats, Relocation>& v) {
+    const std::byte* end = ReadFrom(in.data(), in.data() + in.size(), v);
+    return in.subspan(static_cast<size_t>(end - in.data()));
+}
+#endif
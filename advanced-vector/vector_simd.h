@@ -0,0 +1,526 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+// Векторизованные операции над Vector арифметических типов: Fill, Find, Count, Contains,
+// Sum, MinMax и Equal. Ядра написаны на векторных расширениях GCC/Clang один раз для всех
+// ширин регистра и собираются под несколько наборов инструкций; при первом вызове
+// выбирается лучший набор, который поддерживают процессор и ОС:
+//   x86-64 — SSE2 (16 байт), AVX2 (32 байта), AVX-512BW (64 байта);
+//   ARM с NEON — 16 байт.
+// Если Vector::kAlignment не меньше ширины регистра (например, с AlignedAllocator<T, 64>),
+// ядра читают буфер выровненными загрузками.
+//
+// Результаты совпадают с последовательными алгоритмами std::, кроме Sum для чисел
+// с плавающей точкой: слагаемые суммируются в другом порядке, поэтому округление может
+// отличаться. MinMax для диапазонов с NaN возвращает неопределённую пару
+
+enum class SimdLevel {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kAvx512,
+    kNeon,
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86 1
+#elif defined(__GNUC__) && defined(__ARM_NEON)
+#define VECTOR_SIMD_NEON 1
+#endif
+
+// Лучший набор инструкций, который поддерживают процессор и ОС
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(VECTOR_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::kAvx2;
+    }
+    return SimdLevel::kSse2;
+#elif defined(VECTOR_SIMD_NEON)
+    return SimdLevel::kNeon;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+namespace detail::simd {
+
+inline std::atomic<SimdLevel>& ActiveLevel() noexcept {
+    static std::atomic<SimdLevel> level(DetectSimdLevel());
+    return level;
+}
+
+inline bool IsAvailable(SimdLevel level) noexcept {
+    const SimdLevel detected = DetectSimdLevel();
+    if (level == SimdLevel::kScalar || level == detected) {
+        return true;
+    }
+#if defined(VECTOR_SIMD_X86)
+    return level != SimdLevel::kNeon && level < detected;
+#else
+    return false;
+#endif
+}
+
+template <typename T>
+struct Identity {
+    using type = T;
+};
+
+template <typename T>
+constexpr bool kIsSupported = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// Последовательные реализации: уровень kScalar и платформы без векторных расширений
+struct Scalar {
+    template <size_t Align, typename T>
+    static void Fill(T* p, size_t n, T value) noexcept {
+        std::fill_n(p, n, value);
+    }
+
+    template <size_t Align, typename T>
+    static size_t Find(const T* p, size_t n, T value) noexcept {
+        return static_cast<size_t>(std::find(p, p + n, value) - p);
+    }
+
+    template <size_t Align, typename T>
+    static size_t Count(const T* p, size_t n, T value) noexcept {
+        return static_cast<size_t>(std::count(p, p + n, value));
+    }
+
+    template <size_t Align, typename T>
+    static T Sum(const T* p, size_t n) noexcept {
+        return std::accumulate(p, p + n, T{});
+    }
+
+    template <size_t Align, typename T>
+    static std::pair<T, T> MinMax(const T* p, size_t n) noexcept {
+        const auto [min, max] = std::minmax_element(p, p + n);
+        return {*min, *max};
+    }
+
+    template <size_t Align, typename T>
+    static bool Equal(const T* a, const T* b, size_t n) noexcept {
+        return std::equal(a, a + n, b);
+    }
+};
+
+#if defined(VECTOR_SIMD_X86) || defined(VECTOR_SIMD_NEON)
+
+template <typename T, size_t Bytes>
+struct VecType {
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+// Регистр из Bytes / sizeof(T) элементов типа T
+template <typename T, size_t Bytes>
+using Vec = typename VecType<T, Bytes>::type;
+
+// Ядра для регистров по Bytes байт. Векторы не передаются через параметры и возвращаемые
+// значения, поэтому ядра встраиваются в обёртки с любым атрибутом target без смены ABI
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline const T* AssumeAligned(const T* p) noexcept {
+    if constexpr (Align >= Bytes) {
+        return static_cast<const T*>(__builtin_assume_aligned(p, Bytes));
+    } else {
+        return p;
+    }
+}
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline void FillKernel(T* p, size_t n, T value) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t kLanes = Bytes / sizeof(T);
+    p = const_cast<T*>(AssumeAligned<Bytes, Align>(p));
+    const V splat = V{} + value;
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        std::memcpy(p + i, &splat, Bytes);
+    }
+    for (; i < n; ++i) {
+        p[i] = value;
+    }
+}
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline size_t FindKernel(const T* p, size_t n, T value) noexcept {
+    using V = Vec<T, Bytes>;
+    using W = Vec<uint64_t, Bytes>;
+    constexpr size_t kLanes = Bytes / sizeof(T);
+    p = AssumeAligned<Bytes, Align>(p);
+    const V needle = V{} + value;
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        V x;
+        std::memcpy(&x, p + i, Bytes);
+        const auto mask = x == needle;
+        W words;
+        std::memcpy(&words, &mask, Bytes);
+        uint64_t any = 0;
+        for (size_t w = 0; w < Bytes / sizeof(uint64_t); ++w) {
+            any |= words[w];
+        }
+        if (any != 0) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (p[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline size_t CountKernel(const T* p, size_t n, T value) noexcept {
+    using V = Vec<T, Bytes>;
+    using Mask = decltype(V{} == V{});
+    using Lane = std::remove_cv_t<std::remove_reference_t<decltype(std::declval<Mask&>()[0])>>;
+    constexpr size_t kLanes = Bytes / sizeof(T);
+    // Счётчики в дорожках сбрасываются в size_t раньше, чем переполнятся
+    constexpr size_t kMaxBlocks = static_cast<size_t>(
+        std::min<uint64_t>(std::numeric_limits<Lane>::max(), uint64_t{1} << 30));
+    p = AssumeAligned<Bytes, Align>(p);
+    const V needle = V{} + value;
+    size_t count = 0;
+    size_t i = 0;
+    while (n - i >= kLanes) {
+        const size_t blocks = std::min((n - i) / kLanes, kMaxBlocks);
+        Mask counters{};
+        for (size_t block = 0; block < blocks; ++block, i += kLanes) {
+            V x;
+            std::memcpy(&x, p + i, Bytes);
+            counters -= x == needle;
+        }
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            count += static_cast<size_t>(counters[lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        count += p[i] == value;
+    }
+    return count;
+}
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline T SumKernel(const T* p, size_t n) noexcept {
+    // Целые суммируются без знака: переполнение переходит через ноль, как у std::accumulate
+    using Acc = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, Identity<T>>::type;
+    using V = Vec<Acc, Bytes>;
+    constexpr size_t kLanes = Bytes / sizeof(T);
+    const Acc* data = reinterpret_cast<const Acc*>(AssumeAligned<Bytes, Align>(p));
+    V sum0{};
+    V sum1{};
+    size_t i = 0;
+    for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+        V x;
+        V y;
+        std::memcpy(&x, data + i, Bytes);
+        std::memcpy(&y, data + i + kLanes, Bytes);
+        sum0 += x;
+        sum1 += y;
+    }
+    sum0 += sum1;
+    Acc sum{};
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        sum += sum0[lane];
+    }
+    for (; i < n; ++i) {
+        sum += data[i];
+    }
+    return static_cast<T>(sum);
+}
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline std::pair<T, T> MinMaxKernel(const T* p, size_t n) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t kLanes = Bytes / sizeof(T);
+    assert(n > 0);
+    p = AssumeAligned<Bytes, Align>(p);
+    T min = p[0];
+    T max = p[0];
+    size_t i = 0;
+    if (n >= kLanes) {
+        V low;
+        std::memcpy(&low, p, Bytes);
+        V high = low;
+        for (i = kLanes; i + kLanes <= n; i += kLanes) {
+            V x;
+            std::memcpy(&x, p + i, Bytes);
+            low = x < low ? x : low;
+            high = high < x ? x : high;
+        }
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            min = std::min<T>(min, low[lane]);
+            max = std::max<T>(max, high[lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        min = std::min(min, p[i]);
+        max = std::max(max, p[i]);
+    }
+    return {min, max};
+}
+
+template <size_t Bytes, size_t Align, typename T>
+[[gnu::always_inline]] inline bool EqualKernel(const T* a, const T* b, size_t n) noexcept {
+    using V = Vec<T, Bytes>;
+    using W = Vec<uint64_t, Bytes>;
+    constexpr size_t kLanes = Bytes / sizeof(T);
+    a = AssumeAligned<Bytes, Align>(a);
+    b = AssumeAligned<Bytes, Align>(b);
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        V x;
+        V y;
+        std::memcpy(&x, a + i, Bytes);
+        std::memcpy(&y, b + i, Bytes);
+        const auto mask = x != y;
+        W words;
+        std::memcpy(&words, &mask, Bytes);
+        uint64_t any = 0;
+        for (size_t w = 0; w < Bytes / sizeof(uint64_t); ++w) {
+            any |= words[w];
+        }
+        if (any != 0) {
+            return false;
+        }
+    }
+    for (; i < n; ++i) {
+        if (!(a[i] == b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Набор инструкций Name с регистрами по Bytes байт. TARGET — атрибут, под который
+// собираются обёртки; ядра встраиваются в них и используют регистры этой ширины
+#define VECTOR_SIMD_DEFINE_LEVEL(Name, TARGET, Bytes)                                   \
+    struct Name {                                                                       \
+        template <size_t Align, typename T>                                             \
+        TARGET static void Fill(T* p, size_t n, T value) noexcept {                     \
+            FillKernel<Bytes, Align>(p, n, value);                                      \
+        }                                                                               \
+        template <size_t Align, typename T>                                             \
+        TARGET static size_t Find(const T* p, size_t n, T value) noexcept {             \
+            return FindKernel<Bytes, Align>(p, n, value);                               \
+        }                                                                               \
+        template <size_t Align, typename T>                                             \
+        TARGET static size_t Count(const T* p, size_t n, T value) noexcept {            \
+            return CountKernel<Bytes, Align>(p, n, value);                              \
+        }                                                                               \
+        template <size_t Align, typename T>                                             \
+        TARGET static T Sum(const T* p, size_t n) noexcept {                            \
+            return SumKernel<Bytes, Align>(p, n);                                       \
+        }                                                                               \
+        template <size_t Align, typename T>                                             \
+        TARGET static std::pair<T, T> MinMax(const T* p, size_t n) noexcept {           \
+            return MinMaxKernel<Bytes, Align>(p, n);                                    \
+        }                                                                               \
+        template <size_t Align, typename T>                                             \
+        TARGET static bool Equal(const T* a, const T* b, size_t n) noexcept {           \
+            return EqualKernel<Bytes, Align>(a, b, n);                                  \
+        }                                                                               \
+    }
+
+#if defined(VECTOR_SIMD_X86)
+VECTOR_SIMD_DEFINE_LEVEL(Sse2, , 16);
+VECTOR_SIMD_DEFINE_LEVEL(Avx2, __attribute__((target("avx2"))), 32);
+VECTOR_SIMD_DEFINE_LEVEL(Avx512, __attribute__((target("avx512f,avx512bw"))), 64);
+#else
+VECTOR_SIMD_DEFINE_LEVEL(Neon, , 16);
+#endif
+
+#undef VECTOR_SIMD_DEFINE_LEVEL
+
+#endif
+
+// Вызывает op(level) с типом реализации активного набора инструкций
+template <typename Op>
+decltype(auto) Dispatch(Op&& op) {
+    switch (ActiveLevel().load(std::memory_order_relaxed)) {
+#if defined(VECTOR_SIMD_X86)
+    case SimdLevel::kSse2:
+        return op(Sse2{});
+    case SimdLevel::kAvx2:
+        return op(Avx2{});
+    case SimdLevel::kAvx512:
+        return op(Avx512{});
+#elif defined(VECTOR_SIMD_NEON)
+    case SimdLevel::kNeon:
+        return op(Neon{});
+#endif
+    default:
+        return op(Scalar{});
+    }
+}
+
+}  // namespace detail::simd
+
+// Активный набор инструкций
+inline SimdLevel GetSimdLevel() noexcept {
+    return detail::simd::ActiveLevel().load(std::memory_order_relaxed);
+}
+
+// Выбирает набор инструкций для последующих вызовов, например чтобы сравнить их в тестах
+// и бенчмарках. Недоступный набор заменяется найденным DetectSimdLevel. Возвращает
+// выбранный набор
+inline SimdLevel SetSimdLevel(SimdLevel level) noexcept {
+    if (!detail::simd::IsAvailable(level)) {
+        level = DetectSimdLevel();
+    }
+    detail::simd::ActiveLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+namespace simd {
+
+// Операции над диапазонами [first, last)
+
+template <typename T>
+void Fill(T* first, T* last, const typename detail::simd::Identity<T>::type& value) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    detail::simd::Dispatch([&](auto level) {
+        decltype(level)::template Fill<alignof(T)>(first, static_cast<size_t>(last - first), value);
+    });
+}
+
+template <typename T>
+const T* Find(const T* first, const T* last, const typename detail::simd::Identity<T>::type& value) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    return first + detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Find<alignof(T)>(first, static_cast<size_t>(last - first), value);
+    });
+}
+
+template <typename T>
+size_t Count(const T* first, const T* last, const typename detail::simd::Identity<T>::type& value) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Count<alignof(T)>(first, static_cast<size_t>(last - first), value);
+    });
+}
+
+template <typename T>
+bool Contains(const T* first, const T* last, const typename detail::simd::Identity<T>::type& value) noexcept {
+    return simd::Find(first, last, value) != last;
+}
+
+template <typename T>
+T Sum(const T* first, const T* last) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Sum<alignof(T)>(first, static_cast<size_t>(last - first));
+    });
+}
+
+// Наименьший и наибольший элементы непустого диапазона
+template <typename T>
+std::pair<T, T> MinMax(const T* first, const T* last) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    assert(first != last);
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template MinMax<alignof(T)>(first, static_cast<size_t>(last - first));
+    });
+}
+
+// Поэлементное сравнение операцией ==, как у std::equal
+template <typename T>
+bool Equal(const T* first, const T* last, const T* other) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Equal<alignof(T)>(first, other, static_cast<size_t>(last - first));
+    });
+}
+
+// Операции над Vector используют гарантию выравнивания буфера Vector::kAlignment
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+void Fill(Vector<T, Alloc, Growth, Stats, Relocation>& v, const typename detail::simd::Identity<T>::type& value) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    constexpr size_t kAlign = Vector<T, Alloc, Growth, Stats, Relocation>::kAlignment;
+    detail::simd::Dispatch([&](auto level) {
+        decltype(level)::template Fill<kAlign>(v.Data(), v.Size(), value);
+    });
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+const T* Find(const Vector<T, Alloc, Growth, Stats, Relocation>& v, const typename detail::simd::Identity<T>::type& value) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    constexpr size_t kAlign = Vector<T, Alloc, Growth, Stats, Relocation>::kAlignment;
+    return v.Data() + detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Find<kAlign>(v.Data(), v.Size(), value);
+    });
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+T* Find(Vector<T, Alloc, Growth, Stats, Relocation>& v, const typename detail::simd::Identity<T>::type& value) noexcept {
+    const Vector<T, Alloc, Growth, Stats, Relocation>& cv = v;
+    return const_cast<T*>(simd::Find(cv, value));
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+size_t Count(const Vector<T, Alloc, Growth, Stats, Relocation>& v, const typename detail::simd::Identity<T>::type& value) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    constexpr size_t kAlign = Vector<T, Alloc, Growth, Stats, Relocation>::kAlignment;
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Count<kAlign>(v.Data(), v.Size(), value);
+    });
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+bool Contains(const Vector<T, Alloc, Growth, Stats, Relocation>& v, const typename detail::simd::Identity<T>::type& value) noexcept {
+    return simd::Find(v, value) != v.Data() + v.Size();
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+T Sum(const Vector<T, Alloc, Growth, Stats, Relocation>& v) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    constexpr size_t kAlign = Vector<T, Alloc, Growth, Stats, Relocation>::kAlignment;
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Sum<kAlign>(v.Data(), v.Size());
+    });
+}
+
+// Наименьший и наибольший элементы непустого вектора
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation>
+std::pair<T, T> MinMax(const Vector<T, Alloc, Growth, Stats, Relocation>& v) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    assert(v.Size() > 0);
+    constexpr size_t kAlign = Vector<T, Alloc, Growth, Stats, Relocation>::kAlignment;
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template MinMax<kAlign>(v.Data(), v.Size());
+    });
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Relocation
+          , typename OtherAlloc, typename OtherGrowth, typename OtherStats, typename OtherRelocation>
+bool Equal(const Vector<T, Alloc, Growth, Stats, Relocation>& lhs, const Vector<T, OtherAlloc, OtherGrowth, OtherStats, OtherRelocation>& rhs) noexcept {
+    static_assert(detail::simd::kIsSupported<T>, "simd kernels need an arithmetic element type");
+    if (lhs.Size() != rhs.Size()) {
+        return false;
+    }
+    constexpr size_t kAlign = std::min(Vector<T, Alloc, Growth, Stats, Relocation>::kAlignment
+                                       , Vector<T, OtherAlloc, OtherGrowth, OtherStats, OtherRelocation>::kAlignment);
+    return detail::simd::Dispatch([&](auto level) {
+        return decltype(level)::template Equal<kAlign>(lhs.Data(), rhs.Data(), lhs.Size());
+    });
+}
+
+}  // namespace simd